@@ -0,0 +1,18 @@
+/*
+OmniInt.cpp
+
+This is the compiled implementation of OmniInt.h for the omniint library.
+
+Programs that link against the library must define OMNIINT_COMPILED_LIB
+(the CMake target does this automatically) so that OmniInt.h only provides
+declarations.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OMNIINT_COMPILED_LIB
+#define OMNIINT_COMPILED_LIB
+#endif
+
+#include "OmniInt.h"
+#include "OmniInt_impl.h"
@@ -22,600 +22,783 @@ Version 1.6.0
 #include <algorithm>
 #include <limits>
 #include <utility>
+#include <cstddef>
+#include <cstdint>
 
-/**
- * @class OmniInt
- * @brief 一个用于高精度整数计算的类。
- *
- * OmniInt 类支持任意大小的整数，并重载了常见的算术运算符、关系运算符和流运算符，
- * 使得其可以像内置整数类型一样方便地使用。
- * 内部使用一个 vector<int> 来存储数字的每一位，并用一个布尔值表示正负。
- */
-class OmniInt
-{
-public:
-    friend OmniInt gcd(OmniInt a, OmniInt b);
-    // =================================================================
-    // Constructors - 构造函数
-    // =================================================================
-    OmniInt() noexcept;
-    OmniInt(long long n);
-    OmniInt(const std::string &s);
-    OmniInt(const OmniInt &other);
-    OmniInt(OmniInt &&other) noexcept;
-
-    // =================================================================
-    // Assignment Operators - 赋值运算符
-    // =================================================================
-    OmniInt &operator=(long long n);
-    OmniInt &operator=(const std::string &s);
-    OmniInt &operator=(const OmniInt &other);
-    OmniInt &operator=(OmniInt &&other) noexcept;
-
-    // =================================================================
-    // Unary Arithmetic Operators - 一元算术运算符
-    // =================================================================
-    OmniInt operator-() const;
-
-    // =================================================================
-    // Binary Arithmetic Operators - 二元算术运算符
-    // =================================================================
-    OmniInt operator+(const OmniInt &other) const;
-    OmniInt operator-(const OmniInt &other) const;
-    OmniInt operator*(const OmniInt &other) const;
-    OmniInt operator/(const OmniInt &other) const;
-    OmniInt operator%(const OmniInt &other) const;
-
-    // =================================================================
-    // Compound Assignment Operators - 复合赋值运算符
-    // =================================================================
-    OmniInt &operator+=(const OmniInt &other);
-    OmniInt &operator-=(const OmniInt &other);
-    OmniInt &operator*=(const OmniInt &other);
-    OmniInt &operator/=(const OmniInt &other);
-    OmniInt &operator%=(const OmniInt &other);
-
-    // =================================================================
-    // Increment and Decrement Operators - 自增自减运算符
-    // =================================================================
-    OmniInt &operator++();
-    OmniInt &operator--();
-    OmniInt operator++(int);
-    OmniInt operator--(int);
-
-    // =================================================================
-    // Relational Operators - 关系运算符
-    // =================================================================
-    bool operator<(const OmniInt &other) const;
-    bool operator>(const OmniInt &other) const;
-    bool operator<=(const OmniInt &other) const;
-    bool operator>=(const OmniInt &other) const;
-    bool operator==(const OmniInt &other) const;
-    bool operator!=(const OmniInt &other) const;
-
-    // =================================================================
-    // Other Functions - 其他成员函数
-    // =================================================================
-    long long toLongLong() const;
-    std::string toString() const;
-    size_t digitCount() const;
-    OmniInt abs() const;
-
-    // === 辅助函数 ===
-    bool is_zero() const;
-    bool is_even() const;
-
-private:
-    std::vector<int> val; // 存储每一位数字，低位在前 (val[0] 是个位)
-    bool pos;             // 符号位，true 为正数或零，false 为负数
-
-    // 私有辅助函数
-    std::pair<OmniInt, OmniInt> divide_and_remainder(const OmniInt &divisor) const;
-    void trim();
-    int compare(const OmniInt &) const;
-    void halve_in_place();
-};
+// =========================================================================
+// 算法阈值 - Algorithm Thresholds
+// =========================================================================
+// 定义 OMNIINT_USE_TUNED_THRESHOLDS 后，会读取由 tune 工具在本机上生成的
+// OmniInt_thresholds.h；未被覆盖的阈值使用下面的默认值。
+#ifdef OMNIINT_USE_TUNED_THRESHOLDS
+#include "OmniInt_thresholds.h"
+#endif
+
+// 当较短的乘数位数不少于该值时，使用 Karatsuba 乘法，否则使用朴素乘法
+#ifndef OMNIINT_KARATSUBA_THRESHOLD
+#define OMNIINT_KARATSUBA_THRESHOLD 64
+#endif
+
+// 当较短的乘数位数不少于该值时，使用数论变换 (NTT) 乘法
+#ifndef OMNIINT_NTT_THRESHOLD
+#define OMNIINT_NTT_THRESHOLD 192
+#endif
+
+// 当较短的乘数位数不少于该值、且舍入误差上界允许时，使用浮点 FFT 乘法 (优先于 NTT)
+#ifndef OMNIINT_FFT_THRESHOLD
+#define OMNIINT_FFT_THRESHOLD 128
+#endif
+
+// 当 FFT 的误差上界不允许、且较短的乘数位数不少于该值时，使用 Schönhage-Strassen 乘法
+// (优先于 NTT)；超出 NTT 变换长度上限的乘法总是使用它。实测到 6400 万位 SSA 仍比 NTT 慢
+// (约 1.7 倍)，默认不按位数启用；需要时由 tune 工具测量或手动设置
+#ifndef OMNIINT_SSA_THRESHOLD
+#define OMNIINT_SSA_THRESHOLD SIZE_MAX
+#endif
 
 // =========================================================================
-// 实现
+// 运行统计 - Statistics (OMNIINT_STATS)
 // =========================================================================
+// 定义 OMNIINT_STATS 后，每个线程分别统计各算法的调用次数、操作数位数分布、
+// 堆分配次数与耗时，可通过 OmniInt::stats() / OmniInt::reset_stats() 读取和清零。
+// 未定义时，所有统计代码都会被预处理器移除。
+#ifdef OMNIINT_STATS
+#include <chrono>
+
+// 位数分布直方图的桶数：第 k 个桶统计位数在 [2^k, 2^(k+1)) 内的调用
+#ifndef OMNIINT_STATS_BUCKETS
+#define OMNIINT_STATS_BUCKETS 32
+#endif
+
+enum class OmniIntAlgorithm
+{
+    Add,           // 同号加法
+    Subtract,      // 异号加法或同号减法
+    MulSchoolbook, // 朴素乘法
+    MulKaratsuba,  // Karatsuba 乘法
+    MulNtt,        // 数论变换乘法
+    MulFft,        // 浮点 FFT 乘法
+    MulSsa,        // Schönhage-Strassen 乘法
+    LongDivision,  // 逐位试商的长除法
+    SqrtNewton,    // 牛顿迭代开平方
+    GcdEuclid,     // 欧几里得 GCD
+    FromString,    // 字符串解析
+    ToString,      // 转换为字符串
+    Count
+};
 
-// --- 构造函数 ---
-OmniInt::OmniInt() noexcept : pos(true)
+inline const char *omniint_algorithm_name(OmniIntAlgorithm algorithm)
 {
-    val.push_back(0);
+    static const char *const names[] = {"add", "subtract", "mul_schoolbook", "mul_karatsuba",
+                                        "mul_ntt", "mul_fft", "mul_ssa", "long_division", "sqrt_newton",
+                                        "gcd_euclid", "from_string", "to_string"};
+    return names[static_cast<int>(algorithm)];
 }
 
-OmniInt::OmniInt(long long n)
+struct OmniIntAlgorithmStats
 {
-    if (n == 0)
-    {
-        pos = true;
-        val.push_back(0);
-        return;
-    }
-    pos = (n > 0);
-    unsigned long long mag = (n > 0) ? n : -static_cast<unsigned long long>(n);
-    while (mag > 0)
-    {
-        val.push_back(mag % 10);
-        mag /= 10;
-    }
-}
+    unsigned long long calls = 0;
+    unsigned long long allocations = 0; // 调用期间发生的堆分配次数 (包含嵌套调用)
+    unsigned long long nanoseconds = 0; // 调用耗时 (包含嵌套调用)
+    unsigned long long size_histogram[OMNIINT_STATS_BUCKETS] = {};
+};
 
-OmniInt::OmniInt(const std::string &s)
+struct OmniIntStats
 {
-    if (s.empty() || (s.size() == 1 && (s[0] == '+' || s[0] == '-')))
-    {
-        throw std::invalid_argument("Invalid string for OmniInt");
-    }
+    OmniIntAlgorithmStats algorithms[static_cast<int>(OmniIntAlgorithm::Count)];
 
-    int start = 0;
-    if (s[0] == '-')
+    const OmniIntAlgorithmStats &operator[](OmniIntAlgorithm algorithm) const
     {
-        pos = false;
-        start = 1;
+        return algorithms[static_cast<int>(algorithm)];
     }
-    else if (s[0] == '+')
+};
+
+namespace omniint_detail
+{
+    inline OmniIntStats &thread_stats()
     {
-        pos = true;
-        start = 1;
+        static thread_local OmniIntStats stats;
+        return stats;
     }
-    else
+
+    inline unsigned long long &thread_allocations()
     {
-        pos = true;
+        static thread_local unsigned long long allocations = 0;
+        return allocations;
     }
 
-    for (int i = s.size() - 1; i >= start; --i)
+    // 在作用域内统计一次算法调用
+    class stats_scope
     {
-        if (s[i] < '0' || s[i] > '9')
+    public:
+        stats_scope(OmniIntAlgorithm algorithm, size_t limbs)
+            : entry_(thread_stats().algorithms[static_cast<int>(algorithm)]),
+              allocations_(thread_allocations()),
+              start_(std::chrono::steady_clock::now())
         {
-            throw std::invalid_argument("Invalid character in string for OmniInt");
+            size_t bucket = 0;
+            while (limbs > 1 && bucket + 1 < OMNIINT_STATS_BUCKETS)
+            {
+                limbs >>= 1;
+                ++bucket;
+            }
+            ++entry_.calls;
+            ++entry_.size_histogram[bucket];
         }
-        val.push_back(s[i] - '0');
-    }
 
-    trim();
-    if (is_zero())
-    {
-        pos = true;
-    }
-}
+        ~stats_scope()
+        {
+            entry_.allocations += thread_allocations() - allocations_;
+            entry_.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - start_)
+                                      .count();
+        }
 
-OmniInt::OmniInt(const OmniInt &other) : val(other.val), pos(other.pos) {}
+    private:
+        OmniIntAlgorithmStats &entry_;
+        unsigned long long allocations_;
+        std::chrono::steady_clock::time_point start_;
+    };
+} // namespace omniint_detail
 
-OmniInt::OmniInt(OmniInt &&other) noexcept : val(std::move(other.val)), pos(other.pos)
-{
-    // 将源对象置于有效的空状态
-    other.val.clear();
-    other.val.push_back(0);
-    other.pos = true;
-}
+#define OMNIINT_STATS_SCOPE(algorithm, limbs) \
+    omniint_detail::stats_scope omniint_stats_scope_(algorithm, limbs)
+#else
+#define OMNIINT_STATS_SCOPE(algorithm, limbs) ((void)0)
+#endif
 
-// --- 赋值运算符 ---
-OmniInt &OmniInt::operator=(long long n)
-{
-    // 直接调用构造函数和移动赋值，代码复用且安全
-    *this = OmniInt(n);
-    return *this;
-}
+// =========================================================================
+// 内存跟踪 - Memory Tracking (OMNIINT_TRACK_MEMORY)
+// =========================================================================
+// 定义 OMNIINT_TRACK_MEMORY 后，进程内所有 OmniInt 相关的堆分配会被分为两类统计：
+//   - storage: OmniInt 对象自身的数字存储
+//   - scratch: 乘法与除法内部的临时数据 (result_val、Karatsuba 缓冲区、
+//              multiples 倍数表、试商过程中的余数等)
+// 可通过 OmniInt::memory_usage() 读取累计分配量、分配次数、当前占用与峰值占用，
+// 通过 OmniInt::reset_memory_usage() 清零累计值并把峰值重置为当前占用。
+#ifdef OMNIINT_TRACK_MEMORY
+#include <atomic>
+#include <new>
+
+struct OmniIntMemoryCounters
+{
+    unsigned long long bytes_allocated = 0; // 累计分配的字节数
+    unsigned long long allocations = 0;     // 累计分配次数
+    unsigned long long live_bytes = 0;      // 当前仍在使用的字节数
+    unsigned long long peak_live_bytes = 0; // live_bytes 的历史最大值
+};
 
-OmniInt &OmniInt::operator=(const std::string &s)
+struct OmniIntMemoryUsage
 {
-    // 构造-移动惯用法
-    OmniInt temp(s);
-    *this = std::move(temp);
-    return *this;
-}
+    OmniIntMemoryCounters storage;
+    OmniIntMemoryCounters scratch;
+    OmniIntMemoryCounters total;
+};
 
-OmniInt &OmniInt::operator=(const OmniInt &other)
+namespace omniint_detail
 {
-    if (this != &other)
+    class memory_counter
     {
-        val = other.val;
-        pos = other.pos;
-    }
-    return *this;
-}
+    public:
+        void on_allocate(unsigned long long bytes)
+        {
+            bytes_allocated_ += bytes;
+            ++allocations_;
+            unsigned long long live = (live_bytes_ += bytes);
+            unsigned long long peak = peak_live_bytes_.load(std::memory_order_relaxed);
+            while (live > peak && !peak_live_bytes_.compare_exchange_weak(peak, live))
+            {
+            }
+        }
 
-OmniInt &OmniInt::operator=(OmniInt &&other) noexcept
-{
-    if (this != &other)
+        void on_deallocate(unsigned long long bytes) { live_bytes_ -= bytes; }
+
+        OmniIntMemoryCounters snapshot() const
+        {
+            OmniIntMemoryCounters c;
+            c.bytes_allocated = bytes_allocated_;
+            c.allocations = allocations_;
+            c.live_bytes = live_bytes_;
+            c.peak_live_bytes = peak_live_bytes_;
+            return c;
+        }
+
+        void reset()
+        {
+            bytes_allocated_ = 0;
+            allocations_ = 0;
+            peak_live_bytes_ = live_bytes_.load();
+        }
+
+    private:
+        std::atomic<unsigned long long> bytes_allocated_{0};
+        std::atomic<unsigned long long> allocations_{0};
+        std::atomic<unsigned long long> live_bytes_{0};
+        std::atomic<unsigned long long> peak_live_bytes_{0};
+    };
+
+    // 下标 0 为 storage，1 为 scratch，2 为两者之和
+    inline memory_counter *memory_counters()
     {
-        val = std::move(other.val);
-        pos = other.pos;
-        other.val.clear();
-        other.val.push_back(0);
-        other.pos = true;
+        static memory_counter counters[3];
+        return counters;
     }
-    return *this;
-}
 
-// --- 一元运算符 ---
-OmniInt OmniInt::operator-() const
-{
-    if (is_zero())
+    // 大于 0 时，当前线程的新分配计入 scratch
+    inline int &thread_scratch_depth()
     {
-        return *this;
+        static thread_local int depth = 0;
+        return depth;
     }
-    OmniInt result = *this;
-    result.pos = !pos;
-    return result;
-}
 
-// --- 二元运算符 (调用复合赋值实现) ---
-OmniInt OmniInt::operator+(const OmniInt &other) const
-{
-    OmniInt result = *this;
-    result += other;
-    return result;
-}
+    // 把作用域内 (或 end() 之前) 的分配计入 scratch
+    class scratch_scope
+    {
+    public:
+        scratch_scope() : active_(true) { ++thread_scratch_depth(); }
+        ~scratch_scope() { end(); }
 
-OmniInt OmniInt::operator-(const OmniInt &other) const
-{
-    OmniInt result = *this;
-    result -= other;
-    return result;
-}
+        void end()
+        {
+            if (active_)
+            {
+                --thread_scratch_depth();
+                active_ = false;
+            }
+        }
+
+    private:
+        scratch_scope(const scratch_scope &);
+        scratch_scope &operator=(const scratch_scope &);
+        bool active_;
+    };
+} // namespace omniint_detail
 
-OmniInt OmniInt::operator*(const OmniInt &other) const
+#define OMNIINT_SCRATCH_SCOPE() omniint_detail::scratch_scope omniint_scratch_scope_
+#define OMNIINT_SCRATCH_END() omniint_scratch_scope_.end()
+#else
+#define OMNIINT_SCRATCH_SCOPE() ((void)0)
+#define OMNIINT_SCRATCH_END() ((void)0)
+#endif
+
+// =========================================================================
+// 跟踪钩子 - Tracing (OMNIINT_TRACE / OMNIINT_USDT)
+// =========================================================================
+// 乘法、除法、开平方、gcd 以及字符串转换在进入和退出时会触发跟踪事件：
+//   - OMNIINT_TRACE: 调用通过 OmniInt::set_trace_callback() 注册的回调函数
+//   - OMNIINT_USDT:  触发 Linux USDT 探针 omniint:op_entry / omniint:op_exit
+//                    (参数依次为操作编号、两个操作数的位数；exit 额外带耗时纳秒数)，
+//                    需要 systemtap 的 <sys/sdt.h>
+// 启用任一选项时，这些入口函数会被标记为不可内联，以便在火焰图中单独显示。
+#if defined(OMNIINT_TRACE) || defined(OMNIINT_USDT)
+#include <atomic>
+#include <chrono>
+#ifdef OMNIINT_USDT
+#include <sys/sdt.h>
+#endif
+
+enum class OmniIntTraceOp
+{
+    Multiply,
+    Divide,
+    Sqrt,
+    Gcd,
+    FromString,
+    ToString
+};
+
+enum class OmniIntTraceEvent
 {
-    OmniInt result = *this;
-    result *= other;
-    return result;
-}
+    Enter,
+    Exit
+};
 
-OmniInt OmniInt::operator/(const OmniInt &other) const
+inline const char *omniint_trace_op_name(OmniIntTraceOp op)
 {
-    return divide_and_remainder(other).first;
+    static const char *const names[] = {"multiply", "divide", "sqrt", "gcd", "from_string", "to_string"};
+    return names[static_cast<int>(op)];
 }
 
-OmniInt OmniInt::operator%(const OmniInt &other) const
+struct OmniIntTraceRecord
 {
-    return divide_and_remainder(other).second;
-}
+    OmniIntTraceEvent event;
+    OmniIntTraceOp op;
+    size_t size_a;                  // 第一个操作数的位数
+    size_t size_b;                  // 第二个操作数的位数，单操作数运算为 0
+    unsigned long long nanoseconds; // 仅 Exit 事件有效：本次运算的耗时
+};
+
+typedef void (*OmniIntTraceCallback)(const OmniIntTraceRecord &record);
 
-// --- 复合赋值运算符 (就地修改) ---
-OmniInt &OmniInt::operator+=(const OmniInt &other)
+namespace omniint_detail
 {
-    if (pos == other.pos)
+    inline std::atomic<OmniIntTraceCallback> &trace_callback()
+    {
+        static std::atomic<OmniIntTraceCallback> callback(nullptr);
+        return callback;
+    }
+
+    // 在作用域的进入与退出时触发跟踪事件
+    class trace_scope
     {
-        val.resize(std::max(val.size(), other.val.size()), 0);
-        int carry = 0;
-        for (size_t i = 0; i < val.size(); ++i)
+    public:
+        trace_scope(OmniIntTraceOp op, size_t size_a, size_t size_b)
+            : op_(op), size_a_(size_a), size_b_(size_b), start_(std::chrono::steady_clock::now())
         {
-            int sum = val[i] + carry + (i < other.val.size() ? other.val[i] : 0);
-            val[i] = sum % 10;
-            carry = sum / 10;
+#ifdef OMNIINT_USDT
+            DTRACE_PROBE3(omniint, op_entry, static_cast<int>(op_), size_a_, size_b_);
+#endif
+#ifdef OMNIINT_TRACE
+            if (OmniIntTraceCallback callback = trace_callback().load(std::memory_order_acquire))
+            {
+                OmniIntTraceRecord record = {OmniIntTraceEvent::Enter, op_, size_a_, size_b_, 0};
+                callback(record);
+            }
+#endif
         }
-        if (carry)
+
+        ~trace_scope()
         {
-            val.push_back(carry);
+            unsigned long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::steady_clock::now() - start_)
+                                        .count();
+            (void)ns;
+#ifdef OMNIINT_USDT
+            DTRACE_PROBE4(omniint, op_exit, static_cast<int>(op_), size_a_, size_b_, ns);
+#endif
+#ifdef OMNIINT_TRACE
+            if (OmniIntTraceCallback callback = trace_callback().load(std::memory_order_acquire))
+            {
+                OmniIntTraceRecord record = {OmniIntTraceEvent::Exit, op_, size_a_, size_b_, ns};
+                callback(record);
+            }
+#endif
         }
-    }
-    else
-    {
-        *this -= (-other);
-    }
-    return *this;
-}
 
-OmniInt &OmniInt::operator-=(const OmniInt &other)
+    private:
+        OmniIntTraceOp op_;
+        size_t size_a_;
+        size_t size_b_;
+        std::chrono::steady_clock::time_point start_;
+    };
+} // namespace omniint_detail
+
+#define OMNIINT_TRACE_SCOPE(op, size_a, size_b) \
+    omniint_detail::trace_scope omniint_trace_scope_(op, size_a, size_b)
+
+#if defined(_MSC_VER)
+#define OMNIINT_NOINLINE __declspec(noinline)
+#else
+#define OMNIINT_NOINLINE __attribute__((noinline))
+#endif
+#else
+#define OMNIINT_TRACE_SCOPE(op, size_a, size_b) ((void)0)
+#define OMNIINT_NOINLINE
+#endif
+
+// =========================================================================
+// 取消与进度 - Cancellation and Progress
+// =========================================================================
+// 长时间运行的运算 (乘法、除法、开平方、toString) 会在内部循环中检查当前线程的
+// 运算上下文：上下文中的取消标志被置位时抛出 OmniIntCancelled，并把完成比例写入
+// 上下文中的进度变量。没有设置上下文时 (默认情况) 每次检查只是读取一个线程局部指针。
+// 上下文由 OmniIntAsync.h 中的异步接口设置，也可以用 operation_context_guard 手动设置。
+#include <atomic>
+
+class OmniIntCancelled : public std::runtime_error
 {
-    if (pos != other.pos)
+public:
+    OmniIntCancelled() : std::runtime_error("OmniInt operation cancelled") {}
+};
+
+namespace omniint_detail
+{
+    struct operation_context
     {
-        *this += (-other);
-        return *this;
-    }
+        const std::atomic<bool> *cancelled; // 取消标志，可以为空
+        std::atomic<double> *progress;      // 完成比例 [0, 1]，可以为空
+        bool claimed;                       // 已有外层运算负责报告进度
+        bool slicing;                       // 乘法内核正在按子问题划分进度区间
+        double base, width;                 // 当前子问题在整体进度中的区间 [base, base + width)
+    };
 
-    if (abs() < other.abs())
+    inline operation_context *&current_operation()
     {
-        *this = -(other - *this);
-        return *this;
+        static thread_local operation_context *context = nullptr;
+        return context;
     }
 
-    int borrow = 0;
-    for (size_t i = 0; i < val.size(); ++i)
+    // 在作用域内为当前线程设置运算上下文
+    class operation_context_guard
     {
-        int diff = val[i] - borrow - (i < other.val.size() ? other.val[i] : 0);
-        if (diff < 0)
+    public:
+        operation_context_guard(const std::atomic<bool> *cancelled, std::atomic<double> *progress)
+            : saved_(current_operation())
         {
-            diff += 10;
-            borrow = 1;
+            context_.cancelled = cancelled;
+            context_.progress = progress;
+            context_.claimed = false;
+            context_.slicing = false;
+            context_.base = 0;
+            context_.width = 1;
+            current_operation() = &context_;
         }
-        else
+        ~operation_context_guard() { current_operation() = saved_; }
+
+        operation_context_guard(const operation_context_guard &) = delete;
+        operation_context_guard &operator=(const operation_context_guard &) = delete;
+
+    private:
+        operation_context context_;
+        operation_context *saved_;
+    };
+
+    inline void poll_cancelled(const operation_context *context)
+    {
+        if (context->cancelled && context->cancelled->load(std::memory_order_relaxed))
         {
-            borrow = 0;
+            throw OmniIntCancelled();
         }
-        val[i] = diff;
     }
-    trim();
-    if (is_zero())
-    {
-        pos = true;
-    }
-    return *this;
-}
 
-OmniInt &OmniInt::operator*=(const OmniInt &other)
-{
-    // 处理任意一方为零的平凡情况
-    if (this->is_zero() || other.is_zero())
+    /**
+     * @brief 最外层的运算负责报告进度；被嵌套调用的运算 (例如除法内部的乘法) 只检查取消标志
+     */
+    class progress_scope
     {
-        *this = 0;
-        return *this;
-    }
+    public:
+        explicit progress_scope(bool slicing = false) : context_(current_operation()), owner_(false)
+        {
+            if (!context_)
+                return;
+            poll_cancelled(context_);
+            if (!context_->claimed)
+            {
+                owner_ = true;
+                context_->claimed = true;
+                context_->slicing = slicing;
+                context_->base = 0;
+                context_->width = 1;
+                report(0);
+            }
+        }
 
-    // 1. 准备阶段
-    // 结果的符号由两个操作数的符号决定
-    bool result_pos = (this->pos == other.pos);
+        ~progress_scope()
+        {
+            if (owner_)
+            {
+                context_->claimed = false;
+                context_->slicing = false;
+            }
+        }
 
-    // 结果的位数最多是两个操作数位数之和，分配一个足够大的向量
-    std::vector<int> result_val(this->val.size() + other.val.size(), 0);
+        progress_scope(const progress_scope &) = delete;
+        progress_scope &operator=(const progress_scope &) = delete;
 
-    // 2. 纯乘法累加阶段
-    //   - 遍历 this 的每一位 (val[i])
-    //   - 遍历 other 的每一位 (other.val[j])
-    //   - 将乘积 val[i] * other.val[j] 累加到 result_val 的第 i+j 位
-    for (size_t i = 0; i < this->val.size(); ++i)
-    {
-        for (size_t j = 0; j < other.val.size(); ++j)
+        // 检查取消标志，并报告已完成 done / total
+        void checkpoint(size_t done, size_t total)
         {
-            result_val[i + j] += this->val[i] * other.val[j];
+            if (!context_)
+                return;
+            poll_cancelled(context_);
+            if (owner_ && total > 0)
+                report(static_cast<double>(done) / total);
         }
-    }
 
-    // 3. 进位处理阶段
-    //   - 从低位到高位遍历 result_val
-    //   - 将每一位的数字和来自前一位的进位相加
-    //   - 更新当前位为 total % 10，并计算新的进位 total / 10
-    int carry = 0;
-    for (size_t i = 0; i < result_val.size(); ++i)
-    {
-        int total = result_val[i] + carry;
-        result_val[i] = total % 10;
-        carry = total / 10;
-    }
+        void finish()
+        {
+            if (owner_)
+                report(1);
+        }
+
+    private:
+        void report(double fraction)
+        {
+            if (context_->progress)
+                context_->progress->store(fraction, std::memory_order_relaxed);
+        }
 
-    // 如果最高位还有进位，将其添加到向量末尾
-    while (carry > 0)
+        operation_context *context_;
+        bool owner_;
+    };
+
+    /**
+     * @brief 把当前乘法子问题的进度区间等分为 count 份，依次分给各个子乘法
+     *
+     * 每完成一个子乘法调用一次 next()，它会检查取消标志并把进度推进到下一份的起点。
+     */
+    class progress_slices
     {
-        result_val.push_back(carry % 10);
-        carry /= 10;
-    }
+    public:
+        explicit progress_slices(size_t count) : context_(current_operation())
+        {
+            if (!context_)
+                return;
+            poll_cancelled(context_);
+            saved_base_ = context_->base;
+            saved_width_ = context_->width;
+            if (context_->slicing)
+                context_->width /= count;
+        }
 
-    // 4. 收尾阶段
-    // 将计算好的结果更新到 this 对象
-    this->val = result_val;
-    this->pos = result_pos;
+        ~progress_slices()
+        {
+            if (!context_)
+                return;
+            context_->base = saved_base_;
+            context_->width = saved_width_;
+        }
 
-    // 调用 trim() 移除可能存在的前导零 (在 vector 中是尾部的零)
-    // 这一步是必要的，因为我们预分配的 result_val 可能比实际结果长
-    this->trim();
+        progress_slices(const progress_slices &) = delete;
+        progress_slices &operator=(const progress_slices &) = delete;
 
-    return *this;
-}
+        void next()
+        {
+            if (!context_)
+                return;
+            poll_cancelled(context_);
+            if (context_->slicing)
+            {
+                context_->base += context_->width;
+                if (context_->progress)
+                    context_->progress->store(context_->base, std::memory_order_relaxed);
+            }
+        }
 
-OmniInt &OmniInt::operator/=(const OmniInt &other)
-{
-    *this = *this / other;
-    return *this;
-}
+    private:
+        operation_context *context_;
+        double saved_base_ = 0, saved_width_ = 0;
+    };
+} // namespace omniint_detail
 
-OmniInt &OmniInt::operator%=(const OmniInt &other)
+// =========================================================================
+// 缓冲区类型 - Buffers
+// =========================================================================
+// 数字存储和算法中的临时缓冲区统一使用 omniint_detail::buffer。未启用统计或内存跟踪时
+// 它就是 std::vector；启用时使用下面的分配器记录每次分配。
+#if defined(OMNIINT_STATS) || defined(OMNIINT_TRACK_MEMORY)
+namespace omniint_detail
 {
-    *this = *this % other;
-    return *this;
-}
+    template <typename T>
+    struct tracking_allocator
+    {
+        typedef T value_type;
 
-// --- 自增自减 ---
-OmniInt &OmniInt::operator++() { return *this += 1; }
-OmniInt &OmniInt::operator--() { return *this -= 1; }
-OmniInt OmniInt::operator++(int)
-{
-    OmniInt temp = *this;
-    ++*this;
-    return temp;
-}
-OmniInt OmniInt::operator--(int)
-{
-    OmniInt temp = *this;
-    --*this;
-    return temp;
-}
+        tracking_allocator() noexcept {}
+        template <typename U>
+        tracking_allocator(const tracking_allocator<U> &) noexcept {}
 
-// --- 关系运算符 ---
-bool OmniInt::operator<(const OmniInt &other) const { return compare(other) == -1; }
-bool OmniInt::operator>(const OmniInt &other) const { return compare(other) == 1; }
-bool OmniInt::operator<=(const OmniInt &other) const { return compare(other) <= 0; }
-bool OmniInt::operator>=(const OmniInt &other) const { return compare(other) >= 0; }
-bool OmniInt::operator==(const OmniInt &other) const { return compare(other) == 0; }
-bool OmniInt::operator!=(const OmniInt &other) const { return compare(other) != 0; }
+#ifdef OMNIINT_TRACK_MEMORY
+        // 每块内存前预留一个对齐的头部，记录分配时所属的类别，释放时据此扣减
+        static const size_t header = alignof(std::max_align_t);
 
-// --- 其他成员函数 ---
-long long OmniInt::toLongLong() const
-{
-    if (pos)
-    {
-        static const OmniInt llong_max(std::numeric_limits<long long>::max());
-        if (*this > llong_max)
+        T *allocate(size_t n)
         {
-            throw std::overflow_error("OmniInt value too large for long long");
+#ifdef OMNIINT_STATS
+            ++thread_allocations();
+#endif
+            const size_t bytes = n * sizeof(T);
+            char *raw = static_cast<char *>(::operator new(bytes + header));
+            const int category = thread_scratch_depth() > 0 ? 1 : 0;
+            *reinterpret_cast<int *>(raw) = category;
+            memory_counters()[category].on_allocate(bytes);
+            memory_counters()[2].on_allocate(bytes);
+            return reinterpret_cast<T *>(raw + header);
         }
-    }
-    else
-    {
-        static const OmniInt llong_min(std::numeric_limits<long long>::min());
-        if (*this < llong_min)
+
+        void deallocate(T *p, size_t n) noexcept
         {
-            throw std::overflow_error("OmniInt value too small for long long");
+            char *raw = reinterpret_cast<char *>(p) - header;
+            const size_t bytes = n * sizeof(T);
+            memory_counters()[*reinterpret_cast<int *>(raw)].on_deallocate(bytes);
+            memory_counters()[2].on_deallocate(bytes);
+            ::operator delete(raw);
         }
-    }
+#else
+        T *allocate(size_t n)
+        {
+            ++thread_allocations();
+            return std::allocator<T>().allocate(n);
+        }
+        void deallocate(T *p, size_t n) noexcept { std::allocator<T>().deallocate(p, n); }
+#endif
+    };
 
-    long long result = 0;
-    for (int i = val.size() - 1; i >= 0; --i)
-    {
-        result = result * 10 + val[i];
-    }
-    return pos ? result : -result;
-}
+    template <typename T, typename U>
+    bool operator==(const tracking_allocator<T> &, const tracking_allocator<U> &) { return true; }
+    template <typename T, typename U>
+    bool operator!=(const tracking_allocator<T> &, const tracking_allocator<U> &) { return false; }
 
-std::string OmniInt::toString() const
+    template <typename T>
+    using buffer = std::vector<T, tracking_allocator<T>>;
+} // namespace omniint_detail
+#else
+namespace omniint_detail
 {
-    if (is_zero())
-        return "0";
-    std::stringstream ss;
-    if (!pos)
-        ss << '-';
-    for (int i = val.size() - 1; i >= 0; --i)
-    {
-        ss << val[i];
-    }
-    return ss.str();
-}
+    template <typename T>
+    using buffer = std::vector<T>;
+} // namespace omniint_detail
+#endif
 
-size_t OmniInt::digitCount() const
+namespace omniint_detail
 {
-    if (is_zero())
-        return 1;
-    return val.size();
-}
+    struct access;
+} // namespace omniint_detail
 
-OmniInt OmniInt::abs() const
+/**
+ * @class OmniInt
+ * @brief 一个用于高精度整数计算的类。
+ *
+ * OmniInt 类支持任意大小的整数，并重载了常见的算术运算符、关系运算符和流运算符，
+ * 使得其可以像内置整数类型一样方便地使用。
+ * 内部使用一个 vector<int> 来存储数字的每一位，并用一个布尔值表示正负。
+ */
+class OmniInt
 {
-    OmniInt result = *this;
-    result.pos = true;
-    return result;
-}
+public:
+    friend OmniInt gcd(OmniInt a, OmniInt b);
+    friend struct omniint_detail::access;
+    // =================================================================
+    // Constructors - 构造函数
+    // =================================================================
+    OmniInt() noexcept;
+    OmniInt(long long n);
+    OmniInt(const std::string &s);
+    OmniInt(const OmniInt &other);
+    OmniInt(OmniInt &&other) noexcept;
 
-bool OmniInt::is_zero() const
-{
-    return val.size() == 1 && val[0] == 0;
-}
+    // =================================================================
+    // Assignment Operators - 赋值运算符
+    // =================================================================
+    OmniInt &operator=(long long n);
+    OmniInt &operator=(const std::string &s);
+    OmniInt &operator=(const OmniInt &other);
+    OmniInt &operator=(OmniInt &&other) noexcept;
 
-bool OmniInt::is_even() const
-{
-    if (is_zero())
-        return true;
-    return val[0] % 2 == 0;
-}
+    // =================================================================
+    // Unary Arithmetic Operators - 一元算术运算符
+    // =================================================================
+    OmniInt operator-() const;
 
-// --- 私有辅助函数实现 ---
-std::pair<OmniInt, OmniInt> OmniInt::divide_and_remainder(const OmniInt &divisor) const
-{
-    if (divisor.is_zero())
-    {
-        throw std::runtime_error("Division by zero");
-    }
-    if (abs() < divisor.abs())
-    {
-        return {OmniInt(0), *this};
-    }
+    // =================================================================
+    // Binary Arithmetic Operators - 二元算术运算符
+    // =================================================================
+    OmniInt operator+(const OmniInt &other) const;
+    OmniInt operator-(const OmniInt &other) const;
+    OmniInt operator*(const OmniInt &other) const;
+    OmniInt operator/(const OmniInt &other) const;
+    OmniInt operator%(const OmniInt &other) const;
 
-    OmniInt abs_this = abs();
-    OmniInt abs_divisor = divisor.abs();
+    // =================================================================
+    // Compound Assignment Operators - 复合赋值运算符
+    // =================================================================
+    OmniInt &operator+=(const OmniInt &other);
+    OmniInt &operator-=(const OmniInt &other);
+    OmniInt &operator*=(const OmniInt &other);
+    OmniInt &operator/=(const OmniInt &other);
+    OmniInt &operator%=(const OmniInt &other);
 
-    std::vector<OmniInt> multiples(10);
-    for (int i = 1; i <= 9; ++i)
-    {
-        multiples[i] = abs_divisor * i;
-    }
+    // =================================================================
+    // Increment and Decrement Operators - 自增自减运算符
+    // =================================================================
+    OmniInt &operator++();
+    OmniInt &operator--();
+    OmniInt operator++(int);
+    OmniInt operator--(int);
 
-    std::vector<int> quotient_digits;
-    OmniInt current_remainder = 0;
+    // =================================================================
+    // Relational Operators - 关系运算符
+    // =================================================================
+    bool operator<(const OmniInt &other) const;
+    bool operator>(const OmniInt &other) const;
+    bool operator<=(const OmniInt &other) const;
+    bool operator>=(const OmniInt &other) const;
+    bool operator==(const OmniInt &other) const;
+    bool operator!=(const OmniInt &other) const;
 
-    for (int i = abs_this.val.size() - 1; i >= 0; --i)
-    {
-        current_remainder = current_remainder * 10 + abs_this.val[i];
+    // =================================================================
+    // Other Functions - 其他成员函数
+    // =================================================================
+    long long toLongLong() const;
 
-        int low = 0, high = 9, digit = 0;
-        while (low <= high)
-        {
-            int mid = (low + high) / 2;
-            if (multiples[mid] <= current_remainder)
-            {
-                digit = mid;
-                low = mid + 1;
-            }
-            else
-            {
-                high = mid - 1;
-            }
-        }
+    // === 浮点转换 ===
+    // 就近舍入 (平局取偶)，超出浮点范围时为 ±inf
+    double to_double() const;
+    long double to_long_double() const;
+    // 返回 d (0.5 <= |d| < 1，零时为 0) 并设置 exponent，d * 2^exponent 为就近舍入到 double 精度的值，
+    // 指数不受 double 范围限制
+    double to_double_2exp(long long &exponent) const;
+    // 舍去小数部分 (向零取整)
+    // @throw std::domain_error x 为 NaN 或无穷大
+    static OmniInt from_double(double x);
+    static OmniInt from_long_double(long double x);
 
-        current_remainder -= multiples[digit];
-        quotient_digits.push_back(digit);
-    }
+    std::string toString() const;
+    size_t digitCount() const;
+    OmniInt abs() const;
 
-    OmniInt quotient;
-    std::reverse(quotient_digits.begin(), quotient_digits.end());
-    quotient.val = quotient_digits;
-    quotient.trim();
-    quotient.pos = (this->pos == divisor.pos);
-    if (quotient.is_zero())
-    {
-        quotient.pos = true;
-    }
+    // === 辅助函数 ===
+    bool is_zero() const;
+    bool is_even() const;
 
-    OmniInt remainder = current_remainder;
-    remainder.pos = this->pos;
-    if (remainder.is_zero())
-    {
-        remainder.pos = true;
-    }
+#ifdef OMNIINT_STATS
+    // === 运行统计 (仅在定义 OMNIINT_STATS 时可用) ===
+    typedef OmniIntStats Stats;
+    static Stats stats();      // 返回当前线程统计数据的快照
+    static void reset_stats(); // 清零当前线程的统计数据
+#endif
+
+#ifdef OMNIINT_TRACK_MEMORY
+    // === 内存跟踪 (仅在定义 OMNIINT_TRACK_MEMORY 时可用) ===
+    typedef OmniIntMemoryUsage MemoryUsage;
+    static MemoryUsage memory_usage();  // 返回进程内的内存使用快照
+    static void reset_memory_usage();   // 清零累计值，峰值重置为当前占用
+#endif
+
+#ifdef OMNIINT_TRACE
+    // === 跟踪钩子 (仅在定义 OMNIINT_TRACE 时可用) ===
+    // 注册全局回调，传入 nullptr 取消注册；回调可能在任意线程中被并发调用
+    static void set_trace_callback(OmniIntTraceCallback callback);
+#endif
 
-    return {quotient, remainder};
-}
+private:
+    omniint_detail::buffer<int> val; // 存储每一位数字，低位在前 (val[0] 是个位)
+    bool pos;                        // 符号位，true 为正数或零，false 为负数
 
-void OmniInt::trim()
-{
-    while (val.size() > 1 && val.back() == 0)
-    {
-        val.pop_back();
-    }
-}
+    // 私有辅助函数
+    std::pair<OmniInt, OmniInt> divide_and_remainder(const OmniInt &divisor) const;
+    void trim();
+    int compare(const OmniInt &) const;
+    void halve_in_place();
+};
 
-int OmniInt::compare(const OmniInt &other) const
+namespace omniint_detail
 {
-    if (pos != other.pos)
+    /**
+     * @brief 供 OmniInt 的扩展组件 (OmniIntSum 等) 直接读写内部表示的入口
+     *
+     * 直接修改 digits() 后必须调用 normalize()，以去除前导零并保证零的符号为正。
+     */
+    struct access
     {
-        return pos ? 1 : -1;
-    }
-    if (is_zero() && other.is_zero())
-    {
-        return 0;
-    }
+        static buffer<int> &digits(OmniInt &n) { return n.val; }
+        static const buffer<int> &digits(const OmniInt &n) { return n.val; }
+        static bool is_negative(const OmniInt &n) { return !n.pos; }
+        static void set_negative(OmniInt &n, bool negative) { n.pos = !negative; }
 
-    int sign_multiplier = pos ? 1 : -1;
+        static void normalize(OmniInt &n)
+        {
+            if (n.val.empty())
+                n.val.push_back(0);
+            n.trim();
+            if (n.is_zero())
+                n.pos = true;
+        }
+    };
 
-    if (val.size() < other.val.size())
-        return -1 * sign_multiplier;
-    if (val.size() > other.val.size())
-        return 1 * sign_multiplier;
-
-    for (int i = val.size() - 1; i >= 0; --i)
-    {
-        if (val[i] < other.val[i])
-            return -1 * sign_multiplier;
-        if (val[i] > other.val[i])
-            return 1 * sign_multiplier;
-    }
-    return 0;
-}
-
-void OmniInt::halve_in_place()
-{
-    if (is_zero())
-        return;
-    int carry = 0;
-    for (int i = val.size() - 1; i >= 0; --i)
-    {
-        int current_val = val[i] + carry * 10;
-        val[i] = current_val / 2;
-        carry = current_val % 2;
-    }
-    trim();
-}
+    // base^e，按线程缓存 base^(2^k)；扩展组件需要反复求同一底数的幂时使用
+    OmniInt cached_power(const OmniInt &base, size_t e);
+} // namespace omniint_detail
 
 // =========================================================================
 // Non-Member Functions - 非成员函数
@@ -629,85 +812,76 @@ inline OmniInt operator/(long long lhs, const OmniInt &rhs) { return OmniInt(lhs
 inline OmniInt operator%(long long lhs, const OmniInt &rhs) { return OmniInt(lhs) % rhs; }
 
 // --- 流运算符 ---
-std::ostream &operator<<(std::ostream &os, const OmniInt &n)
-{
-    os << n.toString();
-    return os;
-}
-
-std::istream &operator>>(std::istream &is, OmniInt &n)
-{
-    std::string s;
-    if (is >> s)
-    {
-        try
-        {
-            n = s;
-        }
-        catch (const std::invalid_argument &)
-        {
-            // 如果构造失败，设置流的错误状态
-            is.setstate(std::ios_base::failbit);
-        }
-    }
-    return is;
-}
+std::ostream &operator<<(std::ostream &os, const OmniInt &n);
+std::istream &operator>>(std::istream &is, OmniInt &n);
 
 // --- 数学函数 ---
-OmniInt sqrt(const OmniInt &n)
+OmniInt sqrt(const OmniInt &n);
+OmniInt gcd(OmniInt a, OmniInt b);
+
+// --- 整数对数 ---
+// ilog(n, base) = floor(log_base(n))，要求 n >= 1、base >= 2；ilog10(n) 即位数减一
+// is_power_of(n, base) 判断 n 是否为 base 的非负整数次幂 (n <= 0 时为 false)
+size_t ilog(const OmniInt &n, const OmniInt &base);
+size_t ilog2(const OmniInt &n);
+size_t ilog10(const OmniInt &n);
+bool is_power_of(const OmniInt &n, const OmniInt &base);
+
+// --- 截断乘法 ---
+// 设 la、lb 为 a、b 的位数，s = max(la + lb - n, 0)，结果的符号与 a * b 相同:
+//   mul_low(a, b, n)  = |a * b| mod 10^n，只计算乘积的低 n 位
+//   mul_high(a, b, n) = floor(|a * b| / 10^s)，只计算乘积的高 n 位 (乘积只有 la + lb - 1 位时为 n - 1 位)
+OmniInt mul_low(const OmniInt &a, const OmniInt &b, size_t n);
+OmniInt mul_high(const OmniInt &a, const OmniInt &b, size_t n);
+
+// =========================================================================
+// Prepared Multiplication - 预变换乘法
+// =========================================================================
+
+/**
+ * @class OmniIntPreparedMultiplier
+ * @brief 保存一个固定乘数 x 的 FFT / NTT 变换结果，反复计算 x * y 时省去 x 的正变换。
+ *
+ * 算法的选择与 operator* 相同。变换长度由 x 与 y 的位数共同决定，每种长度的变换在
+ * 第一次用到时计算并缓存。operator* 选择 FFT / NTT 以外的算法 (SSA、Karatsuba、普通乘法) 时
+ * mul() 直接调用 operator*。
+ * mul() 会修改缓存，同一个对象不能被多个线程同时使用。
+ */
+class OmniIntPreparedMultiplier
 {
-    if (n < 0)
-    {
-        throw std::domain_error("Cannot compute square root of a negative number.");
-    }
-    if (n.is_zero())
-    {
-        return 0;
-    }
+public:
+    explicit OmniIntPreparedMultiplier(const OmniInt &x);
 
-    // 步骤 1: 构造一个绝对可靠的“过高”初始值 (overestimate)
-    // 这是保证后续循环逻辑正确性的关键。
-    // 一个 d 位数 n, 其 sqrt(n) 的位数是 ceil(d/2)。
-    // 我们构造一个比结果多一位的数 10^ceil(d/2)，它必然大于真实的 sqrt(n)。
-    size_t digits = n.digitCount();
-    size_t root_exponent = (digits + 1) / 2;
-    std::string guess_str(root_exponent + 1, '0');
-    guess_str[0] = '1';
-    OmniInt x(guess_str);
-
-    // 步骤 2: 牛顿迭代。由于初始值 x 保证偏高，迭代序列将稳定单调递减。
-    OmniInt last_x;
-    do
-    {
-        last_x = x;
-        x = (x + n / x) / 2;
-    } while (x < last_x);
+    // 返回 x * y
+    OmniInt mul(const OmniInt &y);
 
-    // 步骤 3: 循环结束时，last_x 是最接近真实根的候选值
-    x = last_x;
+    const OmniInt &value() const { return value_; }
 
-    // 步骤 4: 最终修正，防止因整数截断导致的 off-by-one 错误
-    // 如果我们得到的 x 的平方大于 n，说明 x 偏大了1，需要减一。
-    if (x * x > n)
+    // 释放缓存的变换
+    void clear_cache();
+
+private:
+    struct cached_transform
     {
-        x -= 1;
-    }
-    return x;
-}
+        size_t length;      // 变换长度
+        size_t limb_digits; // FFT 每个系数的位数，0 表示 NTT 变换
+        omniint_detail::buffer<std::uint64_t> ntt;
+        omniint_detail::buffer<double> re, im;
+    };
 
-OmniInt gcd(OmniInt a, OmniInt b)
-{
-    a = a.abs();
-    b = b.abs();
+    const cached_transform &transform(size_t length, size_t limb_digits);
 
-    while (!b.is_zero())
-    {
-        OmniInt r = a % b;
-        a = std::move(b);
-        b = std::move(r);
-    }
+    OmniInt value_;
+    std::vector<cached_transform> transforms_;
+};
 
-    return a;
-}
+// =========================================================================
+// 实现
+// =========================================================================
+// 默认为仅头文件模式，实现位于 OmniInt_impl.h。
+// 链接预编译的 omniint 库时定义 OMNIINT_COMPILED_LIB，实现由 OmniInt.cpp 提供。
+#ifndef OMNIINT_COMPILED_LIB
+#include "OmniInt_impl.h"
+#endif
 
-#endif // OmniInt_H
\ No newline at end of file
+#endif // OmniInt_H
@@ -0,0 +1,244 @@
+/*
+OmniIntAccumulator.h
+
+This is a header file for summing OmniInt values from multiple threads.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniIntAccumulator_H
+#define OmniIntAccumulator_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "OmniInt.h"
+#include "OmniIntSum.h"
+
+/**
+ * @class OmniIntAccumulator
+ * @brief 可由多个线程同时调用 add() 的累加器。
+ *
+ * 内部维护若干个分片，每个分片是一个带互斥锁的 OmniIntSum 部分和。
+ * 每个线程第一次使用时被轮流分配到一个分片上，此后总是写入同一个分片，
+ * 因此线程数不超过分片数时各线程之间没有锁竞争。result() 把所有分片合并后返回总和。
+ */
+class OmniIntAccumulator
+{
+public:
+    /**
+     * @brief 构造累加器
+     * @param shards 分片数，0 表示使用 std::thread::hardware_concurrency()
+     */
+    explicit OmniIntAccumulator(size_t shards = 0)
+    {
+        if (shards == 0)
+        {
+            shards = std::thread::hardware_concurrency();
+        }
+        if (shards == 0)
+        {
+            shards = 1;
+        }
+        // 每个分片单独分配，避免相邻分片的互斥锁落在同一缓存行上
+        shards_.reserve(shards);
+        for (size_t i = 0; i < shards; ++i)
+        {
+            shards_.emplace_back(new shard);
+        }
+    }
+
+    OmniIntAccumulator(const OmniIntAccumulator &) = delete;
+    OmniIntAccumulator &operator=(const OmniIntAccumulator &) = delete;
+
+    // =================================================================
+    // Accumulation - 累加 (线程安全)
+    // =================================================================
+    void add(const OmniInt &n)
+    {
+        shard &s = local_shard();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.sum += n;
+    }
+
+    void subtract(const OmniInt &n)
+    {
+        shard &s = local_shard();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.sum -= n;
+    }
+
+    // 合并一个在别处算好的部分和
+    void add(const OmniIntSum &partial)
+    {
+        shard &s = local_shard();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.sum += partial;
+    }
+
+    // =================================================================
+    // Reading - 读取
+    // =================================================================
+    // 与并发的 add() 同时调用时，返回的是某一时刻各分片部分和的总和
+    OmniInt result() const
+    {
+        OmniIntSum total;
+        for (size_t i = 0; i < shards_.size(); ++i)
+        {
+            std::lock_guard<std::mutex> lock(shards_[i]->mutex);
+            total += shards_[i]->sum;
+        }
+        return total.value();
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < shards_.size(); ++i)
+        {
+            std::lock_guard<std::mutex> lock(shards_[i]->mutex);
+            shards_[i]->sum.clear();
+        }
+    }
+
+    size_t shard_count() const { return shards_.size(); }
+
+private:
+    struct shard
+    {
+        mutable std::mutex mutex;
+        OmniIntSum sum;
+    };
+
+    // 每个线程获得一个固定的序号，按序号轮流映射到分片
+    static size_t thread_slot()
+    {
+        static std::atomic<size_t> next_slot(0);
+        static thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+        return slot;
+    }
+
+    shard &local_shard() { return *shards_[thread_slot() % shards_.size()]; }
+
+    std::vector<std::unique_ptr<shard>> shards_;
+};
+
+// =========================================================================
+// Parallel Algorithms - 并行算法
+// =========================================================================
+
+/**
+ * @brief 用多个线程计算 [first, last) 中所有元素的和
+ *
+ * 区间被切分为连续的若干段，每个线程用各自的 OmniIntSum 累加一段，最后合并。
+ * 元素较少时线程数会相应减少 (每个线程至少处理 min_per_thread 个元素)。
+ *
+ * @param threads 线程数，0 表示使用 std::thread::hardware_concurrency()
+ * @param min_per_thread 每个线程至少处理的元素个数
+ */
+template <typename ForwardIt>
+OmniInt parallel_sum(ForwardIt first, ForwardIt last, unsigned threads = 0, size_t min_per_thread = 1024)
+{
+    const size_t count = static_cast<size_t>(std::distance(first, last));
+    if (threads == 0)
+    {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (min_per_thread == 0)
+    {
+        min_per_thread = 1;
+    }
+    size_t workers = std::min<size_t>(threads == 0 ? 1 : threads, (count + min_per_thread - 1) / min_per_thread);
+    if (workers <= 1)
+    {
+        OmniIntSum sum;
+        for (; first != last; ++first)
+        {
+            sum += *first;
+        }
+        return sum.value();
+    }
+
+    std::vector<OmniIntSum> partials(workers);
+    std::vector<std::exception_ptr> errors(workers);
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+
+    // 每个线程在自己栈上的 OmniIntSum 中累加，结束时才写入 partials。
+    // 若直接写 partials[index]，相邻元素的 bound_ 与缓冲区头部落在同一缓存行上，每次累加都会互相失效
+    auto sum_range = [&partials, &errors](size_t index, ForwardIt begin, ForwardIt end)
+    {
+        try
+        {
+            OmniIntSum sum;
+            for (; begin != end; ++begin)
+            {
+                sum += *begin;
+            }
+            partials[index] = std::move(sum);
+        }
+        catch (...)
+        {
+            errors[index] = std::current_exception();
+        }
+    };
+
+    // 前 count % workers 段各多分一个元素；最后一段在当前线程中计算
+    ForwardIt begin = first;
+    try
+    {
+        for (size_t i = 0; i < workers; ++i)
+        {
+            ForwardIt end = begin;
+            std::advance(end, count / workers + (i < count % workers ? 1 : 0));
+            if (i + 1 < workers)
+            {
+                pool.emplace_back(sum_range, i, begin, end);
+            }
+            else
+            {
+                sum_range(i, begin, end);
+            }
+            begin = end;
+        }
+    }
+    catch (...)
+    {
+        // 创建线程失败时，先等待已启动的线程结束再抛出
+        for (size_t i = 0; i < pool.size(); ++i)
+        {
+            pool[i].join();
+        }
+        throw;
+    }
+    for (size_t i = 0; i < pool.size(); ++i)
+    {
+        pool[i].join();
+    }
+
+    OmniIntSum total;
+    for (size_t i = 0; i < workers; ++i)
+    {
+        if (errors[i])
+        {
+            std::rethrow_exception(errors[i]);
+        }
+        total += partials[i];
+    }
+    return total.value();
+}
+
+// 对整个容器求和
+template <typename Range>
+OmniInt parallel_sum(const Range &range, unsigned threads = 0, size_t min_per_thread = 1024)
+{
+    return parallel_sum(std::begin(range), std::end(range), threads, min_per_thread);
+}
+
+#endif // OmniIntAccumulator_H
@@ -0,0 +1,235 @@
+/*
+OmniIntAsync.h
+
+This is a header file for running long OmniInt operations asynchronously,
+with progress reporting and cancellation.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniIntAsync_H
+#define OmniIntAsync_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OmniInt.h"
+
+namespace omniint_detail
+{
+    struct async_access;
+}
+
+/**
+ * @class OmniIntCancelToken
+ * @brief 取消令牌。复制后的令牌共享同一个取消标志，因此一个令牌可以同时取消多个运算。
+ *
+ * 运算在内部循环中检查取消标志，被取消后 get() 抛出 OmniIntCancelled。
+ */
+class OmniIntCancelToken
+{
+public:
+    OmniIntCancelToken() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { flag_->store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return flag_->load(std::memory_order_relaxed); }
+
+private:
+    friend struct omniint_detail::async_access;
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+/**
+ * @class OmniIntFuture
+ * @brief 异步运算的句柄：在 std::future 的基础上增加进度查询和取消。
+ */
+template <typename T>
+class OmniIntFuture
+{
+public:
+    OmniIntFuture() {}
+
+    // 等待运算完成并取得结果；运算抛出的异常 (包括 OmniIntCancelled) 在此重新抛出
+    T get() { return future_.get(); }
+    void wait() const { future_.wait(); }
+
+    template <typename Rep, typename Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period> &timeout) const
+    {
+        return future_.wait_for(timeout);
+    }
+
+    bool valid() const { return future_.valid(); }
+    bool ready() const { return future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+    // 完成比例，范围 [0, 1]。乘法按子问题估计，除法按商的位数，开平方按迭代次数估计
+    double progress() const { return progress_ ? progress_->load(std::memory_order_relaxed) : 0.0; }
+
+    void cancel() const { token_.cancel(); }
+    const OmniIntCancelToken &token() const { return token_; }
+
+    // 取出底层的 std::future (之后本句柄不再有效)
+    std::future<T> release() { return std::move(future_); }
+
+private:
+    friend struct omniint_detail::async_access;
+
+    std::future<T> future_;
+    std::shared_ptr<std::atomic<double>> progress_;
+    OmniIntCancelToken token_;
+};
+
+namespace omniint_detail
+{
+    /**
+     * @brief 异步运算使用的内部线程池
+     *
+     * 线程数默认等于 std::thread::hardware_concurrency()，在第一次提交任务时创建。
+     * 程序退出时尚未开始的任务会被丢弃，对应的 get() 抛出 std::future_error。
+     */
+    class async_pool
+    {
+    public:
+        static async_pool &instance()
+        {
+            static async_pool pool;
+            return pool;
+        }
+
+        void submit(std::function<void()> task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push_back(std::move(task));
+            }
+            ready_.notify_one();
+        }
+
+        size_t size() const { return workers_.size(); }
+
+    private:
+        async_pool() : stopping_(false)
+        {
+            size_t count = std::thread::hardware_concurrency();
+            if (count == 0)
+                count = 2;
+            for (size_t i = 0; i < count; ++i)
+            {
+                workers_.emplace_back(&async_pool::run, this);
+            }
+        }
+
+        ~async_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+                tasks_.clear();
+            }
+            ready_.notify_all();
+            for (size_t i = 0; i < workers_.size(); ++i)
+            {
+                workers_[i].join();
+            }
+        }
+
+        void run()
+        {
+            for (;;)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    while (!stopping_ && tasks_.empty())
+                        ready_.wait(lock);
+                    if (stopping_)
+                        return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<std::function<void()>> tasks_;
+        std::vector<std::thread> workers_;
+        bool stopping_;
+    };
+
+    struct async_access
+    {
+        /**
+         * @brief 在内部线程池中运行 fn()，运行期间为工作线程设置取消与进度上下文
+         */
+        template <typename R, typename Fn>
+        static OmniIntFuture<R> submit(Fn fn, const OmniIntCancelToken &token)
+        {
+            OmniIntFuture<R> result;
+            result.token_ = token;
+            result.progress_ = std::make_shared<std::atomic<double>>(0.0);
+
+            std::shared_ptr<std::atomic<bool>> cancelled = token.flag_;
+            std::shared_ptr<std::atomic<double>> progress = result.progress_;
+            std::shared_ptr<std::packaged_task<R()>> task = std::make_shared<std::packaged_task<R()>>(
+                [fn, cancelled, progress]() -> R
+                {
+                    // 还未开始就已被取消
+                    if (cancelled->load(std::memory_order_relaxed))
+                        throw OmniIntCancelled();
+                    operation_context_guard guard(cancelled.get(), progress.get());
+                    R value = fn();
+                    progress->store(1.0, std::memory_order_relaxed);
+                    return value;
+                });
+            result.future_ = task->get_future();
+            async_pool::instance().submit([task]() { (*task)(); });
+            return result;
+        }
+    };
+} // namespace omniint_detail
+
+// =========================================================================
+// Asynchronous Operations - 异步运算
+// =========================================================================
+// 操作数按值复制到任务中，调用方在任务完成前可以自由修改或销毁原对象。
+
+inline OmniIntFuture<OmniInt> async_multiply(const OmniInt &a, const OmniInt &b,
+                                             const OmniIntCancelToken &token = OmniIntCancelToken())
+{
+    auto fn = [a, b]() { return a * b; };
+    return omniint_detail::async_access::submit<OmniInt>(fn, token);
+}
+
+inline OmniIntFuture<OmniInt> async_divide(const OmniInt &a, const OmniInt &b,
+                                           const OmniIntCancelToken &token = OmniIntCancelToken())
+{
+    auto fn = [a, b]() { return a / b; };
+    return omniint_detail::async_access::submit<OmniInt>(fn, token);
+}
+
+inline OmniIntFuture<OmniInt> async_sqrt(const OmniInt &n,
+                                         const OmniIntCancelToken &token = OmniIntCancelToken())
+{
+    auto fn = [n]() { return sqrt(n); };
+    return omniint_detail::async_access::submit<OmniInt>(fn, token);
+}
+
+inline OmniIntFuture<std::string> async_to_string(const OmniInt &n,
+                                                  const OmniIntCancelToken &token = OmniIntCancelToken())
+{
+    auto fn = [n]() { return n.toString(); };
+    return omniint_detail::async_access::submit<std::string>(fn, token);
+}
+
+#endif // OmniIntAsync_H
@@ -0,0 +1,319 @@
+/*
+OmniIntCheckpoint.h
+
+This is a header file for the OmniInt binary format and for saving and
+restoring the state of long computations.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniIntCheckpoint_H
+#define OmniIntCheckpoint_H
+
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "OmniInt.h"
+
+// =========================================================================
+// Binary Format - 二进制格式
+// =========================================================================
+// 一个 OmniInt 的二进制表示 (多字节整数均为小端序):
+//   "OMNI"            4 字节魔数
+//   version           1 字节，当前为 1
+//   sign              1 字节，0 为非负，1 为负
+//   digit_count       8 字节，十进制位数
+//   digits            (digit_count + 1) / 2 字节，每字节两个数位 (低 4 位在前)，低位在前
+//   checksum          8 字节，digits 部分的 FNV-1a 64 位校验和
+
+namespace omniint_detail
+{
+    inline std::uint64_t fnv1a(const char *data, size_t size, std::uint64_t hash = 14695981039346656037ULL)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    inline void write_u64(std::ostream &os, std::uint64_t value)
+    {
+        char bytes[8];
+        for (int i = 0; i < 8; ++i)
+            bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        os.write(bytes, 8);
+    }
+
+    inline std::uint64_t read_u64(std::istream &is)
+    {
+        unsigned char bytes[8];
+        if (!is.read(reinterpret_cast<char *>(bytes), 8))
+            throw std::runtime_error("Truncated OmniInt binary data");
+        std::uint64_t value = 0;
+        for (int i = 7; i >= 0; --i)
+            value = (value << 8) | bytes[i];
+        return value;
+    }
+
+    inline std::string read_bytes(std::istream &is, size_t size)
+    {
+        std::string bytes(size, '\0');
+        if (size > 0 && !is.read(&bytes[0], size))
+            throw std::runtime_error("Truncated OmniInt binary data");
+        return bytes;
+    }
+
+    // 支持超过 2 GiB 的文件偏移
+    inline bool seek_file(std::FILE *file, std::uint64_t offset)
+    {
+#if defined(_WIN32)
+        return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+
+    inline std::uint64_t file_size(std::FILE *file)
+    {
+#if defined(_WIN32)
+        _fseeki64(file, 0, SEEK_END);
+        return static_cast<std::uint64_t>(_ftelli64(file));
+#else
+        fseeko(file, 0, SEEK_END);
+        return static_cast<std::uint64_t>(ftello(file));
+#endif
+    }
+
+    // 把已写入的数据刷新到磁盘
+    inline bool sync_file(std::FILE *file)
+    {
+        if (std::fflush(file) != 0)
+            return false;
+#if defined(_WIN32)
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+} // namespace omniint_detail
+
+/**
+ * @brief 以二进制格式写入 n
+ */
+inline std::ostream &write_binary(std::ostream &os, const OmniInt &n)
+{
+    const omniint_detail::buffer<int> &d = omniint_detail::access::digits(n);
+    std::string packed((d.size() + 1) / 2, '\0');
+    for (size_t i = 0; i < d.size(); ++i)
+        packed[i / 2] = static_cast<char>(packed[i / 2] | (d[i] << (4 * (i % 2))));
+
+    os.write("OMNI", 4);
+    os.put(1);
+    os.put(omniint_detail::access::is_negative(n) ? 1 : 0);
+    omniint_detail::write_u64(os, d.size());
+    os.write(packed.data(), packed.size());
+    omniint_detail::write_u64(os, omniint_detail::fnv1a(packed.data(), packed.size()));
+    return os;
+}
+
+/**
+ * @brief 读取 write_binary 写入的数据
+ * @throw std::runtime_error 数据被截断、格式不符或校验和不一致
+ */
+inline OmniInt read_binary(std::istream &is)
+{
+    std::string header = omniint_detail::read_bytes(is, 6);
+    if (header.compare(0, 4, "OMNI") != 0 || header[4] != 1 || (header[5] != 0 && header[5] != 1))
+        throw std::runtime_error("Not OmniInt binary data");
+    const std::uint64_t count = omniint_detail::read_u64(is);
+    if (count == 0)
+        throw std::runtime_error("Corrupted OmniInt binary data");
+    const std::string packed = omniint_detail::read_bytes(is, static_cast<size_t>((count + 1) / 2));
+    if (omniint_detail::read_u64(is) != omniint_detail::fnv1a(packed.data(), packed.size()))
+        throw std::runtime_error("OmniInt binary data checksum mismatch");
+
+    OmniInt result;
+    omniint_detail::buffer<int> &d = omniint_detail::access::digits(result);
+    d.resize(static_cast<size_t>(count));
+    for (size_t i = 0; i < d.size(); ++i)
+    {
+        int digit = (static_cast<unsigned char>(packed[i / 2]) >> (4 * (i % 2))) & 0xF;
+        if (digit > 9)
+            throw std::runtime_error("Corrupted OmniInt binary data");
+        d[i] = digit;
+    }
+    omniint_detail::access::normalize(result);
+    omniint_detail::access::set_negative(result, header[5] == 1 && !result.is_zero());
+    return result;
+}
+
+// =========================================================================
+// Checkpoints - 检查点
+// =========================================================================
+
+/**
+ * @class OmniIntCheckpoint
+ * @brief 一次长时间计算的可恢复状态：若干个命名的 OmniInt 与整数计数器。
+ *
+ * save() 先写入同目录下的临时文件并刷新到磁盘，再重命名覆盖原文件，
+ * 因此任何时刻被中断，磁盘上要么是旧的完整检查点，要么是新的完整检查点。
+ * (Windows 上重命名前需要先删除旧文件，两步之间被中断时只剩临时文件。)
+ */
+class OmniIntCheckpoint
+{
+public:
+    OmniIntCheckpoint() {}
+
+    void set(const std::string &key, const OmniInt &value) { values_[key] = value; }
+    void set_counter(const std::string &key, std::uint64_t value) { counters_[key] = value; }
+
+    bool has(const std::string &key) const { return values_.count(key) != 0; }
+    bool has_counter(const std::string &key) const { return counters_.count(key) != 0; }
+
+    const OmniInt &get(const std::string &key) const
+    {
+        std::map<std::string, OmniInt>::const_iterator it = values_.find(key);
+        if (it == values_.end())
+            throw std::out_of_range("No OmniInt named '" + key + "' in checkpoint");
+        return it->second;
+    }
+
+    std::uint64_t counter(const std::string &key) const
+    {
+        std::map<std::string, std::uint64_t>::const_iterator it = counters_.find(key);
+        if (it == counters_.end())
+            throw std::out_of_range("No counter named '" + key + "' in checkpoint");
+        return it->second;
+    }
+
+    void clear()
+    {
+        values_.clear();
+        counters_.clear();
+    }
+
+    /**
+     * @brief 原子地把检查点写入 path
+     * @throw std::runtime_error 无法写入或刷新到磁盘
+     */
+    void save(const std::string &path) const
+    {
+        std::ostringstream body;
+        body.write("OMCK", 4);
+        body.put(1);
+        omniint_detail::write_u64(body, counters_.size());
+        for (std::map<std::string, std::uint64_t>::const_iterator it = counters_.begin(); it != counters_.end(); ++it)
+        {
+            write_key(body, it->first);
+            omniint_detail::write_u64(body, it->second);
+        }
+        omniint_detail::write_u64(body, values_.size());
+        for (std::map<std::string, OmniInt>::const_iterator it = values_.begin(); it != values_.end(); ++it)
+        {
+            write_key(body, it->first);
+            write_binary(body, it->second);
+        }
+        const std::string data = body.str();
+        std::ostringstream tail;
+        omniint_detail::write_u64(tail, omniint_detail::fnv1a(data.data(), data.size()));
+        const std::string checksum = tail.str();
+
+        const std::string temp = path + ".tmp";
+        std::FILE *file = std::fopen(temp.c_str(), "wb");
+        if (!file)
+            throw std::runtime_error("Cannot create checkpoint file: " + temp);
+        bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size() &&
+                  std::fwrite(checksum.data(), 1, checksum.size(), file) == checksum.size() &&
+                  omniint_detail::sync_file(file);
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok)
+        {
+            std::remove(temp.c_str());
+            throw std::runtime_error("Failed writing checkpoint file: " + temp);
+        }
+#if defined(_WIN32)
+        std::remove(path.c_str());
+#endif
+        if (std::rename(temp.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temp.c_str());
+            throw std::runtime_error("Cannot replace checkpoint file: " + path);
+        }
+    }
+
+    /**
+     * @brief 从 path 读取检查点
+     * @return 文件不存在时返回 false (此时状态被清空)
+     * @throw std::runtime_error 文件存在但已损坏
+     */
+    bool load(const std::string &path)
+    {
+        clear();
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        std::string data;
+        char chunk[1 << 16];
+        size_t got;
+        while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+            data.append(chunk, got);
+        std::fclose(file);
+
+        if (data.size() < 8)
+            throw std::runtime_error("Truncated checkpoint file: " + path);
+        std::istringstream tail(data.substr(data.size() - 8));
+        data.resize(data.size() - 8);
+        if (omniint_detail::read_u64(tail) != omniint_detail::fnv1a(data.data(), data.size()))
+            throw std::runtime_error("Checkpoint checksum mismatch: " + path);
+
+        std::istringstream body(data);
+        std::string magic = omniint_detail::read_bytes(body, 5);
+        if (magic.compare(0, 4, "OMCK") != 0 || magic[4] != 1)
+            throw std::runtime_error("Not an OmniInt checkpoint file: " + path);
+        for (std::uint64_t n = omniint_detail::read_u64(body); n > 0; --n)
+        {
+            std::string key = read_key(body);
+            counters_[key] = omniint_detail::read_u64(body);
+        }
+        for (std::uint64_t n = omniint_detail::read_u64(body); n > 0; --n)
+        {
+            std::string key = read_key(body);
+            values_[key] = read_binary(body);
+        }
+        return true;
+    }
+
+private:
+    static void write_key(std::ostream &os, const std::string &key)
+    {
+        omniint_detail::write_u64(os, key.size());
+        os.write(key.data(), key.size());
+    }
+
+    static std::string read_key(std::istream &is)
+    {
+        std::uint64_t size = omniint_detail::read_u64(is);
+        if (size > (1 << 16))
+            throw std::runtime_error("Corrupted checkpoint key");
+        return omniint_detail::read_bytes(is, static_cast<size_t>(size));
+    }
+
+    std::map<std::string, OmniInt> values_;
+    std::map<std::string, std::uint64_t> counters_;
+};
+
+#endif // OmniIntCheckpoint_H
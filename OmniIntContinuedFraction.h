@@ -0,0 +1,367 @@
+/*
+OmniIntContinuedFraction.h
+
+This is a header file for continued fraction expansions of rational numbers
+and best rational approximations.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniIntContinuedFraction_H
+#define OmniIntContinuedFraction_H
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "OmniInt.h"
+
+// x 的位数达到该值时，展开时递归地对高位部分求部分商 (half-GCD)；更短时用单字 Lehmer 步
+#ifndef OMNIINT_HGCD_THRESHOLD
+#define OMNIINT_HGCD_THRESHOLD 300
+#endif
+
+namespace omniint_detail
+{
+    namespace continued_fraction
+    {
+        // 单字步中 x 的最大位数，保证矩阵元素都能放进 long long
+        const size_t word_digits = 18;
+
+        /**
+         * @brief 部分商 q1, ..., qk 对应的矩阵 [[q1, 1], [1, 0]] ... [[qk, 1], [1, 0]]
+         *
+         * 若 (x, y) 经过这些商后变成 (x', y')，则 (x, y) = M (x', y')。
+         * 元素都非负，行列式为 (-1)^k。
+         */
+        struct matrix
+        {
+            OmniInt m00, m01, m10, m11;
+            matrix() : m00(1), m01(0), m10(0), m11(1) {}
+            matrix(long long a, long long b, long long c, long long d) : m00(a), m01(b), m10(c), m11(d) {}
+
+            void push(const OmniInt &q)
+            {
+                OmniInt t = q * m00 + m01;
+                m01 = std::move(m00);
+                m00 = std::move(t);
+                t = q * m10 + m11;
+                m11 = std::move(m10);
+                m10 = std::move(t);
+            }
+
+            void pop(const OmniInt &q)
+            {
+                OmniInt t = m00 - q * m01;
+                m00 = std::move(m01);
+                m01 = std::move(t);
+                t = m10 - q * m11;
+                m10 = std::move(m11);
+                m11 = std::move(t);
+            }
+
+            matrix &operator*=(const matrix &o)
+            {
+                OmniInt a = m00 * o.m00 + m01 * o.m10, b = m00 * o.m01 + m01 * o.m11;
+                OmniInt c = m10 * o.m00 + m11 * o.m10, d = m10 * o.m01 + m11 * o.m11;
+                m00 = std::move(a);
+                m01 = std::move(b);
+                m10 = std::move(c);
+                m11 = std::move(d);
+                return *this;
+            }
+
+            // (x, y) <- M^-1 (x, y)；结果非负，因此取绝对值即可消去行列式的符号
+            void apply_inverse(OmniInt &x, OmniInt &y) const
+            {
+                OmniInt nx = (m11 * x - m01 * y).abs();
+                y = (m00 * y - m10 * x).abs();
+                x = std::move(nx);
+            }
+
+            /**
+             * @brief 由截断值 (x0, y0) 求出的商对完整的 (x, y) 是否同样成立 (Jebelean 条件)
+             *
+             * 设 x = x0 * 10^s + x1，y = y0 * 10^s + y1 (0 <= x1, y1 < 10^s)，
+             * 完整的余数对为 M^-1 (x, y) = (x0' * 10^s + ex, y0' * 10^s + ey)，误差项 |ey|、|ex - ey|
+             * 分别小于 max(m00, m10) * 10^s 与 max(m00 + m01, m10 + m11) * 10^s。
+             * 只要完整的余数对仍满足 x' > y' >= 0，每一个商就都与完整展开的相同。
+             */
+            bool valid_for(const OmniInt &x0, const OmniInt &y0) const
+            {
+                return y0 >= std::max(m00, m10) && x0 - y0 >= std::max(m00 + m01, m10 + m11);
+            }
+        };
+
+        // floor(n / 10^s)，n >= 0
+        inline OmniInt shift_down(const OmniInt &n, size_t s)
+        {
+            const buffer<int> &d = access::digits(n);
+            OmniInt result;
+            if (s < d.size())
+            {
+                access::digits(result).assign(d.begin() + s, d.end());
+                access::normalize(result);
+            }
+            return result;
+        }
+
+        // floor(n / 10^s)，要求结果不超过 word_digits 位
+        inline std::uint64_t top_word(const OmniInt &n, size_t s)
+        {
+            const buffer<int> &d = access::digits(n);
+            std::uint64_t value = 0;
+            for (size_t i = d.size(); i-- > s;)
+                value = value * 10 + static_cast<std::uint64_t>(d[i]);
+            return value;
+        }
+
+        inline OmniInt from_word(std::uint64_t v) { return OmniInt(static_cast<long long>(v)); }
+
+        /**
+         * @brief 在机器字上对 (a, b) 做欧几里得步，直到 b < limit 或 b == 0
+         *
+         * truncated 为真时 (a, b) 是完整数对的高位部分，每一步都先检查 Jebelean 条件，
+         * 不满足时停在上一步。商追加到 quotients，矩阵写入 m。
+         */
+        inline void word_steps(std::uint64_t &a, std::uint64_t &b, std::uint64_t limit, bool truncated,
+                               std::vector<OmniInt> &quotients, std::uint64_t m[4])
+        {
+            m[0] = 1, m[1] = 0, m[2] = 0, m[3] = 1;
+            while (b != 0 && b >= limit)
+            {
+                const std::uint64_t q = a / b, r = a - q * b;
+                const std::uint64_t n00 = q * m[0] + m[1], n10 = q * m[2] + m[3];
+                if (truncated && (r < std::max(n00, n10) || b - r < std::max(n00 + m[0], n10 + m[2])))
+                    break;
+                m[1] = m[0], m[0] = n00, m[3] = m[2], m[2] = n10;
+                a = b;
+                b = r;
+                quotients.push_back(from_word(q));
+            }
+        }
+
+        /**
+         * @brief q = floor(x / y)，r = x - q * y，要求 y > 0
+         *
+         * OmniInt 的长除法总要处理被除数的全部数位。商只有 k 位时，先用 x、y 的
+         * 最高 k + 20 位左右的部分估计商 (偏小至多 2)，再修正，代价只与 k 有关。
+         */
+        inline void floor_divide(const OmniInt &x, const OmniInt &y, OmniInt &q, OmniInt &r)
+        {
+            const OmniInt ax = x.abs();
+            const size_t xd = ax.digitCount(), yd = y.digitCount(), keep = (xd > yd ? xd - yd : 0) + 20;
+            q = yd > keep ? shift_down(ax, yd - keep) / (shift_down(y, yd - keep) + 1) : ax / y;
+            r = ax - q * y;
+            while (r >= y)
+            {
+                r -= y;
+                ++q;
+            }
+            if (x < 0)
+            {
+                q = -q;
+                if (!r.is_zero())
+                {
+                    --q;
+                    r = y - r;
+                }
+            }
+        }
+
+        inline void divide_step(OmniInt &x, OmniInt &y, std::vector<OmniInt> &quotients, matrix *M)
+        {
+            OmniInt q, r;
+            floor_divide(x, y, q, r);
+            if (M)
+                M->push(q);
+            quotients.push_back(std::move(q));
+            x = std::move(y);
+            y = std::move(r);
+        }
+
+        inline std::uint64_t power_of_ten(size_t e)
+        {
+            std::uint64_t p = 1;
+            while (e-- > 0)
+                p *= 10;
+            return p;
+        }
+
+        /**
+         * @brief 对 x >= y >= 0 沿欧几里得算法推进，直到 y < 10^stop 或 y == 0
+         *
+         * 部分商追加到 quotients，(x, y) 变为对应的余数对；M 非空时右乘这些商的矩阵。
+         *
+         * 较长时只取 x、y 的高位部分递归地求出一段部分商，用 Jebelean 条件去掉末尾
+         * 可能不成立的几个，再把矩阵一次性作用到完整的数对上 (half-GCD)。每轮用四次
+         * 乘法代替逐个商的长除法，递归使总代价为 O(M(n) log n)。
+         */
+        inline void reduce(OmniInt &x, OmniInt &y, size_t stop, std::vector<OmniInt> &quotients, matrix *M)
+        {
+            while (!y.is_zero() && y.digitCount() > stop)
+            {
+                const size_t n = x.digitCount();
+                if (n <= word_digits)
+                {
+                    std::uint64_t a = top_word(x, 0), b = top_word(y, 0), m[4];
+                    word_steps(a, b, power_of_ten(stop), false, quotients, m);
+                    x = from_word(a);
+                    y = from_word(b);
+                    if (M)
+                        *M *= matrix(static_cast<long long>(m[0]), static_cast<long long>(m[1]),
+                                     static_cast<long long>(m[2]), static_cast<long long>(m[3]));
+                    return;
+                }
+
+                const size_t before = quotients.size();
+                if (n < OMNIINT_HGCD_THRESHOLD)
+                {
+                    // Lehmer：用最高的 word_digits 位在机器字上求商
+                    const size_t s = n - word_digits;
+                    std::uint64_t a = top_word(x, s), b = top_word(y, s), m[4];
+                    const std::uint64_t limit = stop > s ? power_of_ten(stop - s) : 0;
+                    word_steps(a, b, limit, true, quotients, m);
+                    if (quotients.size() != before)
+                    {
+                        const matrix step(static_cast<long long>(m[0]), static_cast<long long>(m[1]),
+                                          static_cast<long long>(m[2]), static_cast<long long>(m[3]));
+                        step.apply_inverse(x, y);
+                        if (M)
+                            *M *= step;
+                        continue;
+                    }
+                }
+                else
+                {
+                    // 每轮至多把 x 缩短一半：取高位部分 (至少截去一半)，递归到其位数的一半
+                    const size_t goal = std::max(stop, n / 2), yd = y.digitCount();
+                    if (yd > goal)
+                    {
+                        const size_t d = yd - goal;
+                        const size_t s = std::max(n > 2 * d ? n - 2 * d : 0, n / 2);
+                        OmniInt x0 = shift_down(x, s), y0 = shift_down(y, s);
+                        matrix step;
+                        reduce(x0, y0, std::max(goal > s ? goal - s : 0, x0.digitCount() / 2 + 1), quotients, &step);
+                        while (quotients.size() != before && !step.valid_for(x0, y0))
+                        {
+                            // 撤销最后一个商：(x0, y0) <- (q * x0 + y0, x0)
+                            const OmniInt &q = quotients.back();
+                            OmniInt previous = q * x0 + y0;
+                            y0 = std::move(x0);
+                            x0 = std::move(previous);
+                            step.pop(q);
+                            quotients.pop_back();
+                        }
+                        if (quotients.size() != before)
+                        {
+                            step.apply_inverse(x, y);
+                            if (M)
+                                *M *= step;
+                            continue;
+                        }
+                    }
+                }
+                // 截断后求不出可靠的商 (相邻商很大或 y 远短于 x)，做一次完整的除法
+                divide_step(x, y, quotients, M);
+            }
+        }
+    } // namespace continued_fraction
+} // namespace omniint_detail
+
+/**
+ * @brief p / q 的简单连分数展开 [a0; a1, a2, ..., ak]
+ *
+ * a0 = floor(p / q) 可以为负或零，其余部分商都是正数；k >= 1 时 ak >= 2，因此展开唯一。
+ * 部分商由 half-GCD 成批求出，而不是对每个商做一次长除法。
+ *
+ * @throw std::runtime_error q 为 0
+ */
+inline std::vector<OmniInt> continued_fraction(const OmniInt &p, const OmniInt &q)
+{
+    if (q.is_zero())
+        throw std::runtime_error("Division by zero");
+    OmniInt x = q.abs(), a0, y;
+    omniint_detail::continued_fraction::floor_divide(q < 0 ? -p : p, x, a0, y);
+    std::vector<OmniInt> quotients(1, a0);
+    omniint_detail::continued_fraction::reduce(x, y, 0, quotients, nullptr);
+    return quotients;
+}
+
+/**
+ * @brief 分母不超过 max_denominator 的分数中最接近 p / q 的一个，以 (分子, 分母) 返回
+ *
+ * 结果为最简分数，分母为正。答案总是某个渐近分数或半渐近分数，
+ * 两者与 p / q 的距离相等时取渐近分数。
+ * 只需要分母不超过 max_denominator 的那一段部分商：p、q 比 max_denominator^2 长得多时，
+ * 先用它们的高位部分求商并验证，验证失败才展开完整的 p / q。
+ *
+ * @throw std::runtime_error q 为 0
+ * @throw std::invalid_argument max_denominator < 1
+ */
+inline std::pair<OmniInt, OmniInt> best_rational_approximation(const OmniInt &p, const OmniInt &q,
+                                                               const OmniInt &max_denominator)
+{
+    namespace cf = omniint_detail::continued_fraction;
+    if (q.is_zero())
+        throw std::runtime_error("Division by zero");
+    if (max_denominator < 1)
+        throw std::invalid_argument("max_denominator must be positive");
+
+    const OmniInt den = q.abs(), num = q < 0 ? -p : p;
+    OmniInt a0, r;
+    cf::floor_divide(num, den, a0, r);
+    std::vector<OmniInt> quotients(1, a0);
+
+    // 部分商 a1..ak 的矩阵的 m00 正是第 k 个渐近分数的分母
+    const size_t margin = 2 * max_denominator.digitCount() + 20;
+    if (den.digitCount() > margin && !r.is_zero())
+    {
+        const size_t s = den.digitCount() - margin;
+        OmniInt x0 = cf::shift_down(den, s), y0 = cf::shift_down(r, s);
+        cf::matrix m;
+        cf::reduce(x0, y0, 0, quotients, &m);
+        while (quotients.size() > 1 && !m.valid_for(x0, y0))
+        {
+            const OmniInt &a = quotients.back();
+            OmniInt previous = a * x0 + y0;
+            y0 = std::move(x0);
+            x0 = std::move(previous);
+            m.pop(a);
+            quotients.pop_back();
+        }
+        if (m.m00 <= max_denominator)
+            quotients.resize(1);
+    }
+    if (quotients.size() == 1)
+    {
+        OmniInt x = den;
+        cf::reduce(x, r, 0, quotients, nullptr);
+    }
+
+    OmniInt p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    for (size_t i = 0; i < quotients.size(); ++i)
+    {
+        OmniInt q2 = q0 + quotients[i] * q1;
+        if (q2 > max_denominator)
+        {
+            // 半渐近分数 (p0 + t p1) / (q0 + t q1)，t 取使分母不超过上限的最大值
+            const OmniInt t = (max_denominator - q0) / q1;
+            OmniInt sp = p0 + t * p1, sq = q0 + t * q1;
+            // 比较 |p1 / q1 - num / den| 与 |sp / sq - num / den|
+            if ((p1 * den - num * q1).abs() * sq <= (sp * den - num * sq).abs() * q1)
+                return std::make_pair(p1, q1);
+            return std::make_pair(sp, sq);
+        }
+        OmniInt p2 = p0 + quotients[i] * p1;
+        p0 = std::move(p1);
+        q0 = std::move(q1);
+        p1 = std::move(p2);
+        q1 = std::move(q2);
+    }
+    return std::make_pair(p1, q1);
+}
+
+#endif // OmniIntContinuedFraction_H
@@ -0,0 +1,134 @@
+/*
+OmniIntDigits.h
+
+This is a header file for reading the decimal digits of an OmniInt
+incrementally, most significant digit first.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniIntDigits_H
+#define OmniIntDigits_H
+
+#include <cstddef>
+#include <iterator>
+#include <ostream>
+#include <string>
+
+#include "OmniInt.h"
+
+/**
+ * @class OmniIntDigitReader
+ * @brief 按从高位到低位的顺序，分块读出 OmniInt 的十进制表示。
+ *
+ * 与 toString() 不同，读取过程中只需要一个块大小的缓冲区，适合把上亿位的结果
+ * 逐块写入文件或网络。负数的第一个块以 '-' 开头。
+ *
+ * 读取器只保存对 OmniInt 的引用，读取期间该对象必须保持存在且不被修改。
+ */
+class OmniIntDigitReader
+{
+public:
+    explicit OmniIntDigitReader(const OmniInt &n, size_t chunk_size = 1 << 16)
+        : digits_(omniint_detail::access::digits(n)),
+          next_(digits_.size()),
+          sign_pending_(omniint_detail::access::is_negative(n)),
+          chunk_size_(chunk_size == 0 ? 1 : chunk_size)
+    {
+    }
+
+    // 读取器只保存引用，不能绑定到临时对象
+    OmniIntDigitReader(OmniInt &&, size_t = 0) = delete;
+
+    /**
+     * @brief 最多读出 max 个字符到 out 中 (不追加 '\0')
+     * @return 实际写入的字符数，返回 0 表示已经读完
+     */
+    size_t read(char *out, size_t max)
+    {
+        size_t written = 0;
+        if (sign_pending_ && written < max)
+        {
+            out[written++] = '-';
+            sign_pending_ = false;
+        }
+        while (written < max && next_ > 0)
+        {
+            out[written++] = static_cast<char>('0' + digits_[--next_]);
+        }
+        return written;
+    }
+
+    /**
+     * @brief 读出下一个块 (最多 chunk_size 个字符)
+     * @return 已经读完时返回 false，chunk 被清空
+     */
+    bool next(std::string &chunk)
+    {
+        chunk.resize(chunk_size_);
+        chunk.resize(read(&chunk[0], chunk_size_));
+        return !chunk.empty();
+    }
+
+    // 尚未读出的字符数 (包括尚未输出的负号)
+    size_t remaining() const { return next_ + (sign_pending_ ? 1 : 0); }
+    bool done() const { return remaining() == 0; }
+
+    // =================================================================
+    // Iteration - 迭代 (每次迭代得到一个块)
+    // =================================================================
+    class iterator
+    {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef std::string value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const std::string *pointer;
+        typedef const std::string &reference;
+
+        iterator() : reader_(nullptr) {}
+        explicit iterator(OmniIntDigitReader *reader) : reader_(reader) { ++*this; }
+
+        reference operator*() const { return chunk_; }
+        pointer operator->() const { return &chunk_; }
+
+        iterator &operator++()
+        {
+            if (reader_ && !reader_->next(chunk_))
+                reader_ = nullptr;
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const { return reader_ == other.reader_; }
+        bool operator!=(const iterator &other) const { return reader_ != other.reader_; }
+
+    private:
+        OmniIntDigitReader *reader_;
+        std::string chunk_;
+    };
+
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+private:
+    const omniint_detail::buffer<int> &digits_;
+    size_t next_; // 下一个要读出的数位的下标 + 1 (数位按低位在前存储)
+    bool sign_pending_;
+    size_t chunk_size_;
+};
+
+/**
+ * @brief 分块把 n 的十进制表示写入流中，内存占用与 chunk_size 成正比
+ */
+inline std::ostream &write_digits(std::ostream &os, const OmniInt &n, size_t chunk_size = 1 << 16)
+{
+    OmniIntDigitReader reader(n, chunk_size);
+    std::string chunk;
+    while (os && reader.next(chunk))
+    {
+        os.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    }
+    return os;
+}
+
+#endif // OmniIntDigits_H
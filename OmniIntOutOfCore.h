@@ -0,0 +1,773 @@
+/*
+OmniIntOutOfCore.h
+
+This is a header file for multiplying OmniInt values stored in files,
+for operands and products larger than the available memory.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniIntOutOfCore_H
+#define OmniIntOutOfCore_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "OmniInt.h"
+#include "OmniIntCheckpoint.h"
+
+/**
+ * @brief 文件乘法的选项
+ */
+struct OmniIntOutOfCoreOptions
+{
+    // 计算过程中允许使用的内存 (字节)。块大小据此估算，实际占用会有一定浮动
+    size_t memory_budget = size_t(256) << 20;
+    // 临时文件所在的目录，为空时与输出文件放在同一目录
+    std::string scratch_dir;
+    // 每块的十进制位数，0 表示根据 memory_budget 自动选择 (主要用于测试)
+    size_t block_digits = 0;
+    // 检查点文件，为空时不保存检查点。存在有效的检查点时从中断处继续计算
+    std::string checkpoint_path;
+    // 两次保存检查点之间至少间隔的秒数，0 表示每完成一块就保存
+    double checkpoint_seconds = 60;
+};
+
+namespace omniint_detail
+{
+    /**
+     * @brief 一个以十进制文本保存的整数文件
+     *
+     * 文件格式与 toString() 相同：可选的 '+' 或 '-'，随后是十进制数字，末尾允许有空白字符。
+     * 打开时扫描一遍文件以确定位数并检查格式，之后按块随机读取。
+     */
+    class decimal_file
+    {
+    public:
+        explicit decimal_file(const std::string &path) : in_(path.c_str(), std::ios::binary), negative_(false)
+        {
+            if (!in_)
+                throw std::runtime_error("Cannot open OmniInt file: " + path);
+
+            char c;
+            std::streamoff offset = 0;
+            if (in_.get(c) && (c == '-' || c == '+'))
+            {
+                negative_ = (c == '-');
+                offset = 1;
+            }
+            first_ = offset;
+            in_.clear();
+            in_.seekg(first_);
+
+            // 逐块检查：数字之后只允许出现空白字符
+            std::vector<char> chunk(1 << 16);
+            bool trailing = false;
+            digits_ = 0;
+            while (in_)
+            {
+                in_.read(chunk.data(), chunk.size());
+                std::streamsize got = in_.gcount();
+                for (std::streamsize i = 0; i < got; ++i)
+                {
+                    char ch = chunk[i];
+                    if (ch >= '0' && ch <= '9' && !trailing)
+                        ++digits_;
+                    else if (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t')
+                        trailing = true;
+                    else
+                        throw std::invalid_argument("Invalid character in OmniInt file: " + path);
+                }
+            }
+            if (digits_ == 0)
+                throw std::invalid_argument("No digits in OmniInt file: " + path);
+            in_.clear();
+        }
+
+        bool negative() const { return negative_; }
+        size_t digits() const { return digits_; }
+
+        // 把第 index 块 (从低位数起，每块 block_digits 位) 按低位在前写入 out，返回该块的位数
+        size_t read_block(size_t index, size_t block_digits, unsigned char *out)
+        {
+            const size_t low = index * block_digits;
+            if (low >= digits_)
+                return 0;
+            const size_t count = std::min(block_digits, digits_ - low);
+            text_.resize(count);
+            in_.clear();
+            in_.seekg(first_ + static_cast<std::streamoff>(digits_ - low - count));
+            in_.read(&text_[0], count);
+            if (static_cast<size_t>(in_.gcount()) != count)
+                throw std::runtime_error("Unexpected end of OmniInt file");
+
+            for (size_t i = 0; i < count; ++i)
+                out[i] = static_cast<unsigned char>(text_[count - 1 - i] - '0');
+            return count;
+        }
+
+    private:
+        std::ifstream in_;
+        bool negative_;
+        std::streamoff first_;
+        size_t digits_;
+        std::string text_;
+    };
+
+    // 关闭临时文件；不保存检查点时同时删除它 (保存检查点时留给下次恢复使用)
+    class scratch_file
+    {
+    public:
+        scratch_file(const std::string &path, bool keep) : file(nullptr), path_(path), keep_(keep) {}
+        ~scratch_file()
+        {
+            if (file)
+                std::fclose(file);
+            if (!keep_)
+                std::remove(path_.c_str());
+        }
+
+        scratch_file(const scratch_file &) = delete;
+        scratch_file &operator=(const scratch_file &) = delete;
+
+        std::FILE *file;
+
+    private:
+        std::string path_;
+        bool keep_;
+    };
+
+    inline std::string scratch_path_for(const std::string &out_path, const std::string &scratch_dir)
+    {
+        if (scratch_dir.empty())
+            return out_path + ".omniint-scratch";
+        std::string::size_type slash = out_path.find_last_of("/\\");
+        std::string name = slash == std::string::npos ? out_path : out_path.substr(slash + 1);
+        return scratch_dir + "/" + name + ".omniint-scratch";
+    }
+
+    inline bool counter_equals(const OmniIntCheckpoint &state, const char *key, std::uint64_t value)
+    {
+        return state.has_counter(key) && state.counter(key) == value;
+    }
+
+    /**
+     * @brief 把低位在前的临时文件转换为高位在前的输出文件，并去除前导零
+     * @return 输出的位数 (不含符号)
+     */
+    inline size_t write_reversed(const std::string &scratch_path, size_t length, bool negative,
+                                 const std::string &out_path, size_t chunk_size)
+    {
+        std::ifstream in(scratch_path.c_str(), std::ios::binary);
+        std::vector<char> chunk(chunk_size);
+
+        // 从高位向低位跳过前导零
+        size_t top = length;
+        while (top > 1)
+        {
+            size_t count = std::min(chunk_size, top - 1);
+            in.seekg(static_cast<std::streamoff>(top - count));
+            in.read(chunk.data(), count);
+            size_t i = count;
+            while (i > 0 && chunk[i - 1] == '0')
+                --i;
+            if (i > 0)
+            {
+                top = top - count + i;
+                break;
+            }
+            top -= count;
+        }
+
+        in.clear();
+        in.seekg(0);
+        const bool zero = (top == 1 && in.get() == '0');
+
+        std::ofstream out(out_path.c_str(), std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error("Cannot create OmniInt file: " + out_path);
+        if (negative && !zero)
+            out.put('-');
+        for (size_t end = top; end > 0;)
+        {
+            size_t count = std::min(chunk_size, end);
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(end - count));
+            in.read(chunk.data(), count);
+            std::reverse(chunk.begin(), chunk.begin() + count);
+            out.write(chunk.data(), count);
+            end -= count;
+        }
+        out.put('\n');
+        if (!out)
+            throw std::runtime_error("Failed writing OmniInt file: " + out_path);
+        return top;
+    }
+
+    /**
+     * @brief 文件乘法使用的数论变换 (Schönhage–Strassen 方式)
+     *
+     * 在环 Z/(10^n + 1) 中做长度 K = 2^log_k 的循环卷积，n 是 K/2 的倍数，
+     * 单位根 w = 10^(2n/K)，乘以单位根的幂只是十进制数位的移动与取反，蝶形运算不需要乘法。
+     * 元素以 n + 1 个十进制数位 (每位一个字节，低位在前) 表示，取值范围 [0, 10^n]。
+     */
+    namespace out_of_core
+    {
+        typedef unsigned char digit;
+
+        // x = 低 n 位 + top * 10^n (top 为较小的有符号整数)，约化回 [0, 10^n]
+        inline void settle(digit *x, size_t n, long long top)
+        {
+            // 10^n = -1，因此 x = 低 n 位 - top
+            long long carry = -top;
+            for (size_t i = 0; i < n && carry != 0; ++i)
+            {
+                const long long v = x[i] + carry;
+                carry = (v < 0 ? v - 9 : v) / 10;
+                x[i] = static_cast<digit>(v - carry * 10);
+            }
+            x[n] = 0;
+            if (carry < 0)
+            {
+                // 低 n 位 - 10^n = 低 n 位 + 1
+                size_t i = 0;
+                while (i < n && x[i] == 9)
+                    x[i++] = 0;
+                if (i < n)
+                    ++x[i];
+                else
+                    x[n] = 1;
+            }
+            else if (carry > 0)
+            {
+                // 低 n 位 + 10^n = 低 n 位 - 1；低 n 位为 0 时结果是 -1 = 10^n
+                size_t i = 0;
+                while (i < n && x[i] == 0)
+                    ++i;
+                if (i < n)
+                {
+                    --x[i];
+                    std::fill(x, x + i, digit(9));
+                }
+                else
+                    x[n] = 1;
+            }
+        }
+
+        // r = a + b，r 可以与 a 或 b 相同
+        inline void add(digit *r, const digit *a, const digit *b, size_t n)
+        {
+            int carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                int v = a[i] + b[i] + carry;
+                carry = v >= 10;
+                r[i] = static_cast<digit>(v - carry * 10);
+            }
+            settle(r, n, a[n] + b[n] + carry);
+        }
+
+        // r = a - b，r 可以与 a 或 b 相同
+        inline void sub(digit *r, const digit *a, const digit *b, size_t n)
+        {
+            int borrow = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                int v = a[i] - b[i] - borrow;
+                borrow = v < 0;
+                r[i] = static_cast<digit>(v + borrow * 10);
+            }
+            settle(r, n, static_cast<long long>(a[n]) - b[n] - borrow);
+        }
+
+        // r = x * 10^s (0 <= s < 2n)，r 不能与 x 相同
+        inline void shift(digit *r, const digit *x, size_t s, size_t n)
+        {
+            // 10^n = -1：移出高端的数位取反后回到低端
+            const long long sign = s < n ? 1 : -1;
+            if (s >= n)
+                s -= n;
+            long long carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const long long source = i < s    ? -static_cast<long long>(x[n - s + i])
+                                         : i == s ? static_cast<long long>(x[0]) - x[n]
+                                                  : static_cast<long long>(x[i - s]);
+                const long long v = sign * source + carry;
+                carry = (v < 0 ? v - 9 : v) / 10;
+                r[i] = static_cast<digit>(v - carry * 10);
+            }
+            settle(r, n, carry);
+        }
+
+        // a = a * b (mod 10^n + 1)，乘法本身在内存中用 OmniInt 完成
+        inline void multiply(digit *a, const digit *b, size_t n)
+        {
+            OmniInt x, y;
+            access::digits(x).assign(a, a + n + 1);
+            access::digits(y).assign(b, b + n + 1);
+            access::normalize(x);
+            access::normalize(y);
+            const OmniInt product = x * y;
+
+            // 乘积不超过 2n + 2 位；按 n 位分段，第 c 段乘以 (10^n)^c = (-1)^c
+            const buffer<int> &p = access::digits(product);
+            std::vector<long long> sum(n, 0);
+            for (size_t i = 0; i < p.size(); ++i)
+                sum[i % n] += (i / n) % 2 ? -p[i] : p[i];
+            long long carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const long long v = sum[i] + carry;
+                carry = (v < 0 ? v - 9 : v) / 10;
+                a[i] = static_cast<digit>(v - carry * 10);
+            }
+            settle(a, n, carry);
+        }
+
+        /**
+         * @brief 变换的参数
+         *
+         * 操作数按 piece 位分块，块 i 与块 j 的乘积落在系数 i + j 上。
+         * 系数 c 满足 K * c < K^2 * 10^(2 piece) <= 10^n，因此逆变换 (未除以 K) 的结果在环中没有回绕。
+         */
+        struct plan
+        {
+            size_t piece;       // 每块的十进制位数
+            size_t a_pieces;    // 被乘数的块数
+            size_t b_pieces;    // 乘数的块数
+            unsigned log_k;     // 变换长度的对数
+            size_t length;      // 变换长度 K
+            size_t n;           // 环 Z/(10^n + 1) 的位数
+            unsigned group_bits; // 每遍在内存中处理 2^group_bits 个元素
+
+            plan(size_t a_digits, size_t b_digits, const OmniIntOutOfCoreOptions &options)
+            {
+                piece = options.block_digits;
+                if (piece == 0)
+                {
+                    // 环的位数约为 2 * piece，逐点乘法 (包括乘法内核的临时数据) 大约每位占用 64 字节，
+                    // 用掉预算的一半；块数过多时 n >= K / 2 会使环变大，因此块长不小于 sqrt(总位数 / 2)
+                    const size_t total = a_digits + b_digits;
+                    piece = std::max<size_t>(options.memory_budget / 256, 1024);
+                    piece = std::max(piece, static_cast<size_t>(std::ceil(std::sqrt(total / 2.0))));
+                    piece = std::min(piece, std::max(a_digits, b_digits));
+                }
+                a_pieces = (a_digits + piece - 1) / piece;
+                b_pieces = (b_digits + piece - 1) / piece;
+
+                log_k = 1;
+                length = 2;
+                while (length < a_pieces + b_pieces - 1)
+                {
+                    length *= 2;
+                    ++log_k;
+                }
+
+                // 10^extra >= K^2，n 取 K/2 的倍数使单位根的幂都是整数位移
+                const size_t extra = static_cast<size_t>(std::ceil(2 * log_k * std::log10(2.0))) + 1;
+                const size_t half = length / 2;
+                n = (2 * piece + extra + half - 1) / half * half;
+
+                // 另一半预算用于每遍分组读入的元素，至少两个
+                const size_t fit = options.memory_budget / 2 / (n + 1);
+                group_bits = 1;
+                while (group_bits < log_k && (size_t(2) << group_bits) <= fit)
+                    ++group_bits;
+            }
+
+            size_t width() const { return n + 1; }
+
+            // w^e 对应的位移，e 可以为负
+            size_t root_shift(long long e) const
+            {
+                const long long k = static_cast<long long>(length);
+                return static_cast<size_t>(((e % k) + k) % k) * (2 * n / length);
+            }
+
+            /**
+             * @brief 按频率抽取的正变换中，下标第 lo 到 hi - 1 位对应的各级蝶形运算
+             *
+             * group 中依次是下标为 first + (t << lo) 的 2^(hi - lo) 个元素；
+             * 对全部分组按 hi 从高到低处理完所有位后，结果是位反转顺序的变换。
+             */
+            void forward(digit *group, size_t first, unsigned lo, unsigned hi, digit *temp) const
+            {
+                const size_t w = width(), count = size_t(1) << (hi - lo);
+                for (unsigned b = hi; b-- > lo;)
+                {
+                    const size_t half = size_t(1) << b, stride = length >> (b + 1), local = size_t(1) << (b - lo);
+                    for (size_t t = 0; t < count; ++t)
+                    {
+                        if (t & local)
+                            continue;
+                        digit *x = group + t * w, *y = group + (t + local) * w;
+                        const size_t j = (first + (t << lo)) & (half - 1);
+                        sub(temp, x, y, n);
+                        add(x, x, y, n);
+                        shift(y, temp, root_shift(static_cast<long long>(j * stride)), n);
+                    }
+                }
+            }
+
+            // 按时间抽取的逆变换 (不除以 K)，输入为位反转顺序，按 lo 从低到高处理
+            void inverse(digit *group, size_t first, unsigned lo, unsigned hi, digit *temp) const
+            {
+                const size_t w = width(), count = size_t(1) << (hi - lo);
+                for (unsigned b = lo; b < hi; ++b)
+                {
+                    const size_t half = size_t(1) << b, stride = length >> (b + 1), local = size_t(1) << (b - lo);
+                    for (size_t t = 0; t < count; ++t)
+                    {
+                        if (t & local)
+                            continue;
+                        digit *x = group + t * w, *y = group + (t + local) * w;
+                        const size_t j = (first + (t << lo)) & (half - 1);
+                        shift(temp, y, root_shift(-static_cast<long long>(j * stride)), n);
+                        sub(y, x, temp, n);
+                        add(x, x, temp, n);
+                    }
+                }
+            }
+        };
+
+        // 计算中的一步：按单元 (元素或分组) 读 source、写 target，重做任意单元的结果不变
+        struct step
+        {
+            enum kind_type
+            {
+                split_a,
+                split_b,
+                forward,
+                pointwise,
+                inverse,
+                carry
+            } kind;
+            unsigned lo, hi;  // forward / inverse：处理的下标位
+            int source, other; // 读取的变换文件 (pointwise 同时读 other)，-1 表示没有
+            int target;        // 写入的变换文件，-1 表示乘积的临时文件
+            size_t units;
+        };
+
+        inline void read_element(std::FILE *file, size_t index, size_t width, digit *out)
+        {
+            if (!seek_file(file, static_cast<std::uint64_t>(index) * width) ||
+                std::fread(out, 1, width, file) != width)
+                throw std::runtime_error("Failed reading out-of-core scratch file");
+        }
+
+        inline void write_element(std::FILE *file, size_t index, size_t width, const digit *in)
+        {
+            if (!seek_file(file, static_cast<std::uint64_t>(index) * width) ||
+                std::fwrite(in, 1, width, file) != width)
+                throw std::runtime_error("Failed writing out-of-core scratch file");
+        }
+    } // namespace out_of_core
+} // namespace omniint_detail
+
+/**
+ * @brief 计算两个文件中整数的乘积，并写入 out_path
+ *
+ * 操作数与乘积都不需要整体装入内存。两个操作数各按 k 位分块，块序列的卷积用数论变换
+ * (Schönhage–Strassen 方式，环 Z/(10^n + 1)，n 约为 2k) 计算，变换数据保存在临时文件中：
+ * 每遍按内存预算读入 2^r 个间隔相同的元素，在内存中完成 r 级蝶形运算后写入另一个文件。
+ * 内存能放下 sqrt(K) 个元素时，正变换与逆变换各只需两遍 (four-step)，一般为 ceil(log2(K) / r) 遍。
+ * 逐点乘积在内存中用快速乘法计算；最后一遍除以 K 并传播进位，乘积以低位在前的顺序写入临时文件，
+ * 再倒序写入输出文件。
+ *
+ * 设 D 为两个操作数的总位数，变换长度 K 约为 D / k (向上取 2 的幂)。计算量为 K 次 n 位乘法加上
+ * 每遍 O(K n) 的加减与位移；每遍读写 K (n + 1) 字节。临时文件 (四个变换文件与乘积) 约占 D 的
+ * 8 到 16 倍字节，两个操作数是同一个文件时 (平方) 少两个变换文件。
+ *
+ * 设置 checkpoint_path 后，会定期把当前的步骤与单元 (以及进位) 保存到检查点 (临时文件先刷新到磁盘)。
+ * 每一步都从一个文件读出、写入另一个文件，重做已完成的单元不影响结果。再次以相同的参数调用时
+ * 从检查点继续；输入、块大小或内存预算与检查点不符时重新开始。计算完成后删除检查点与临时文件。
+ *
+ * 在 OmniIntAsync.h 的上下文中运行时，可以报告进度并响应取消。
+ *
+ * @return 乘积的十进制位数 (不含符号)
+ */
+inline size_t multiply_files(const std::string &a_path, const std::string &b_path, const std::string &out_path,
+                             const OmniIntOutOfCoreOptions &options = OmniIntOutOfCoreOptions())
+{
+    using omniint_detail::out_of_core::digit;
+    using omniint_detail::out_of_core::step;
+
+    omniint_detail::decimal_file a(a_path), b(b_path);
+    const omniint_detail::out_of_core::plan plan(a.digits(), b.digits(), options);
+    const size_t k = plan.piece, w = plan.width(), length = plan.length;
+    const size_t result_blocks = plan.a_pieces + plan.b_pieces;
+    const bool square = a_path == b_path;
+    const bool checkpointing = !options.checkpoint_path.empty();
+    const std::uint64_t negative = a.negative() != b.negative() ? 1 : 0;
+
+    // 变换文件 0/1 属于被乘数，2/3 属于乘数；每一步在同一组的两个文件之间交替读写
+    std::vector<step> steps;
+    int fa = 0, fb = 2;
+    auto add_step = [&steps](step::kind_type kind, unsigned lo, unsigned hi, int source, int other, int target,
+                             size_t units)
+    {
+        const step s = {kind, lo, hi, source, other, target, units};
+        steps.push_back(s);
+    };
+    auto add_forward = [&](int &file)
+    {
+        for (unsigned hi = plan.log_k; hi > 0;)
+        {
+            const unsigned lo = hi > plan.group_bits ? hi - plan.group_bits : 0;
+            add_step(step::forward, lo, hi, file, -1, file ^ 1, length >> (hi - lo));
+            file ^= 1;
+            hi = lo;
+        }
+    };
+    add_step(step::split_a, 0, 0, -1, -1, fa, length);
+    add_forward(fa);
+    if (!square)
+    {
+        add_step(step::split_b, 0, 0, -1, -1, fb, length);
+        add_forward(fb);
+    }
+    add_step(step::pointwise, 0, 0, fa, square ? fa : fb, fa ^ 1, length);
+    fa ^= 1;
+    for (unsigned lo = 0; lo < plan.log_k;)
+    {
+        const unsigned hi = std::min(lo + plan.group_bits, plan.log_k);
+        add_step(step::inverse, lo, hi, fa, -1, fa ^ 1, length >> (hi - lo));
+        fa ^= 1;
+        lo = hi;
+    }
+    add_step(step::carry, 0, 0, fa, -1, -1, result_blocks);
+
+    // 恢复检查点：只有输入的位数、符号与各项参数都一致时才使用
+    OmniIntCheckpoint state;
+    size_t start_step = 0, start_unit = 0;
+    OmniInt carry;
+    bool resume = checkpointing && state.load(options.checkpoint_path) &&
+                  omniint_detail::counter_equals(state, "block_digits", k) &&
+                  omniint_detail::counter_equals(state, "ring_digits", plan.n) &&
+                  omniint_detail::counter_equals(state, "log_length", plan.log_k) &&
+                  omniint_detail::counter_equals(state, "group_bits", plan.group_bits) &&
+                  omniint_detail::counter_equals(state, "a_digits", a.digits()) &&
+                  omniint_detail::counter_equals(state, "b_digits", b.digits()) &&
+                  omniint_detail::counter_equals(state, "negative", negative) &&
+                  omniint_detail::counter_equals(state, "square", square ? 1 : 0) &&
+                  state.has_counter("step") && state.has_counter("next_unit") && state.has("carry") &&
+                  state.counter("step") < steps.size();
+    if (resume)
+    {
+        start_step = static_cast<size_t>(state.counter("step"));
+        start_unit = static_cast<size_t>(state.counter("next_unit"));
+        carry = state.get("carry");
+    }
+    state.clear();
+    state.set_counter("block_digits", k);
+    state.set_counter("ring_digits", plan.n);
+    state.set_counter("log_length", plan.log_k);
+    state.set_counter("group_bits", plan.group_bits);
+    state.set_counter("a_digits", a.digits());
+    state.set_counter("b_digits", b.digits());
+    state.set_counter("negative", negative);
+    state.set_counter("square", square ? 1 : 0);
+
+    const std::string scratch_path = omniint_detail::scratch_path_for(out_path, options.scratch_dir);
+    const char *suffixes[4] = {".a0", ".a1", ".b0", ".b1"};
+    const int file_count = square ? 2 : 4;
+    std::vector<std::string> paths;
+    for (int i = 0; i < file_count; ++i)
+        paths.push_back(scratch_path + suffixes[i]);
+    paths.push_back(scratch_path);
+    const int product = file_count;
+
+    std::vector<std::unique_ptr<omniint_detail::scratch_file>> files;
+    for (size_t i = 0; i < paths.size(); ++i)
+        files.emplace_back(new omniint_detail::scratch_file(paths[i], checkpointing));
+    auto file = [&](int index) { return files[index < 0 ? product : index]->file; };
+
+    if (resume)
+    {
+        // 临时文件丢失，或当前步骤要读的文件不完整时，重新开始
+        for (size_t i = 0; i < files.size() && resume; ++i)
+            resume = (files[i]->file = std::fopen(paths[i].c_str(), "r+b")) != nullptr;
+        const step &current = steps[start_step];
+        const std::uint64_t full = static_cast<std::uint64_t>(length) * w;
+        if (resume && current.source >= 0)
+            resume = omniint_detail::file_size(file(current.source)) >= full;
+        if (resume && current.other >= 0)
+            resume = omniint_detail::file_size(file(current.other)) >= full;
+        if (resume && current.kind == step::carry)
+            resume = omniint_detail::file_size(file(product)) >= static_cast<std::uint64_t>(start_unit) * k;
+        if (!resume)
+        {
+            for (size_t i = 0; i < files.size(); ++i)
+            {
+                if (files[i]->file)
+                    std::fclose(files[i]->file);
+                files[i]->file = nullptr;
+            }
+            start_step = 0;
+            start_unit = 0;
+            carry = 0;
+        }
+    }
+    if (!resume)
+    {
+        for (size_t i = 0; i < files.size(); ++i)
+            if (!(files[i]->file = std::fopen(paths[i].c_str(), "w+b")))
+                throw std::runtime_error("Cannot open scratch file: " + paths[i]);
+    }
+
+    size_t total = 0, done = 0;
+    for (size_t s = 0; s < steps.size(); ++s)
+    {
+        total += steps[s].units;
+        if (s < start_step)
+            done += steps[s].units;
+    }
+    done += start_unit;
+
+    omniint_detail::progress_scope progress;
+    std::vector<digit> group(w << plan.group_bits), temp(w), other(w);
+    std::string text(k, '0');
+    std::chrono::steady_clock::time_point last_save = std::chrono::steady_clock::now();
+    for (size_t s = start_step; s < steps.size(); ++s)
+    {
+        const step &current = steps[s];
+        for (size_t u = s == start_step ? start_unit : 0; u < current.units; ++u)
+        {
+            switch (current.kind)
+            {
+            case step::split_a:
+            case step::split_b:
+            {
+                // 元素 u 是操作数的第 u 块，高位补零
+                std::fill(temp.begin(), temp.end(), digit(0));
+                (current.kind == step::split_a ? a : b).read_block(u, k, temp.data());
+                omniint_detail::out_of_core::write_element(file(current.target), u, w, temp.data());
+                break;
+            }
+            case step::forward:
+            case step::inverse:
+            {
+                // 第 u 组：下标第 lo 到 hi - 1 位变化，其余位固定
+                const size_t count = size_t(1) << (current.hi - current.lo);
+                const size_t inner = u & ((size_t(1) << current.lo) - 1);
+                const size_t first = ((u >> current.lo) << current.hi) | inner;
+                for (size_t t = 0; t < count; ++t)
+                    omniint_detail::out_of_core::read_element(file(current.source), first + (t << current.lo), w,
+                                                              &group[t * w]);
+                if (current.kind == step::forward)
+                    plan.forward(group.data(), first, current.lo, current.hi, temp.data());
+                else
+                    plan.inverse(group.data(), first, current.lo, current.hi, temp.data());
+                for (size_t t = 0; t < count; ++t)
+                    omniint_detail::out_of_core::write_element(file(current.target), first + (t << current.lo), w,
+                                                               &group[t * w]);
+                break;
+            }
+            case step::pointwise:
+            {
+                omniint_detail::out_of_core::read_element(file(current.source), u, w, temp.data());
+                omniint_detail::out_of_core::read_element(file(current.other), u, w, other.data());
+                omniint_detail::out_of_core::multiply(temp.data(), other.data(), plan.n);
+                omniint_detail::out_of_core::write_element(file(current.target), u, w, temp.data());
+                break;
+            }
+            case step::carry:
+            {
+                // 系数 u 等于逆变换结果除以 K，再加上低位的进位
+                OmniInt column = carry;
+                if (u < length)
+                {
+                    omniint_detail::out_of_core::read_element(file(current.source), u, w, temp.data());
+                    OmniInt coefficient;
+                    omniint_detail::buffer<int> &c = omniint_detail::access::digits(coefficient);
+                    c.resize(w);
+                    unsigned long long remainder = 0;
+                    for (size_t i = w; i-- > 0;)
+                    {
+                        const unsigned long long v = remainder * 10 + temp[i];
+                        c[i] = static_cast<int>(v >> plan.log_k);
+                        remainder = v & (length - 1);
+                    }
+                    if (remainder != 0)
+                        throw std::runtime_error("Corrupted scratch file: " + paths[current.source]);
+                    omniint_detail::access::normalize(coefficient);
+                    column += coefficient;
+                }
+
+                // 低 k 位写入临时文件 (低位在前)，其余部分作为进位
+                const omniint_detail::buffer<int> &d = omniint_detail::access::digits(column);
+                for (size_t t = 0; t < k; ++t)
+                    text[t] = static_cast<char>('0' + (t < d.size() ? d[t] : 0));
+                if (!omniint_detail::seek_file(file(product), static_cast<std::uint64_t>(u) * k) ||
+                    std::fwrite(text.data(), 1, k, file(product)) != k)
+                    throw std::runtime_error("Failed writing scratch file: " + scratch_path);
+
+                OmniInt next_carry;
+                if (d.size() > k)
+                {
+                    omniint_detail::buffer<int> &c = omniint_detail::access::digits(next_carry);
+                    c.assign(d.begin() + k, d.end());
+                    omniint_detail::access::normalize(next_carry);
+                }
+                carry = std::move(next_carry);
+                break;
+            }
+            }
+
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            const bool last = s + 1 == steps.size() && u + 1 == current.units;
+            if (checkpointing && !last &&
+                std::chrono::duration<double>(now - last_save).count() >= options.checkpoint_seconds)
+            {
+                // 先把临时文件刷新到磁盘 (上一步的结果可能还没有写入磁盘)，再记录检查点
+                for (size_t i = 0; i < files.size(); ++i)
+                    if (!omniint_detail::sync_file(files[i]->file))
+                        throw std::runtime_error("Failed syncing scratch file: " + paths[i]);
+                state.set_counter("step", s);
+                state.set_counter("next_unit", u + 1);
+                state.set("carry", carry);
+                state.save(options.checkpoint_path);
+                last_save = now;
+            }
+            progress.checkpoint(++done, total + 1);
+        }
+    }
+
+    size_t digits_written = result_blocks * k;
+    if (!carry.is_zero())
+    {
+        // 乘积不超过 result_blocks 块，正常情况下不会出现；保留以防万一
+        std::string rest = carry.toString();
+        std::reverse(rest.begin(), rest.end());
+        std::fwrite(rest.data(), 1, rest.size(), file(product));
+        digits_written += rest.size();
+    }
+    if (std::fflush(file(product)) != 0)
+        throw std::runtime_error("Failed writing scratch file: " + scratch_path);
+
+    size_t digits = omniint_detail::write_reversed(scratch_path, digits_written, negative != 0, out_path,
+                                                   std::max<size_t>(k, 4096));
+    if (checkpointing)
+    {
+        std::remove(options.checkpoint_path.c_str());
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            std::fclose(files[i]->file);
+            files[i]->file = nullptr;
+            std::remove(paths[i].c_str());
+        }
+    }
+    progress.finish();
+    return digits;
+}
+
+#endif // OmniIntOutOfCore_H
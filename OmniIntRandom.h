@@ -0,0 +1,203 @@
+/*
+OmniIntRandom.h
+
+This is a header file for generating uniformly distributed random OmniInt
+values.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniIntRandom_H
+#define OmniIntRandom_H
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+#include "OmniInt.h"
+
+/**
+ * @class OmniIntRandomEngine
+ * @brief xoshiro256** 伪随机数生成器，满足 UniformRandomBitGenerator 的要求。
+ *
+ * 每次调用只需几次移位与异或，比 std::mt19937_64 更快、状态更小，适合大量生成随机数位。
+ * 不适用于密码学用途。
+ */
+class OmniIntRandomEngine
+{
+public:
+    typedef std::uint64_t result_type;
+
+    explicit OmniIntRandomEngine(std::uint64_t seed = 0x9E3779B97F4A7C15ULL) { this->seed(seed); }
+
+    // 用 splitmix64 把种子扩展为 256 位状态
+    void seed(std::uint64_t seed)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            std::uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            state_[i] = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~static_cast<result_type>(0); }
+
+    result_type operator()()
+    {
+        const std::uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        const std::uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    std::uint64_t state_[4];
+};
+
+namespace omniint_detail
+{
+    // 每个线程一个默认生成器，种子取自 std::random_device
+    inline OmniIntRandomEngine &random_engine()
+    {
+        static thread_local OmniIntRandomEngine engine(
+            (static_cast<std::uint64_t>(std::random_device()()) << 32) ^ std::random_device()());
+        return engine;
+    }
+
+    /**
+     * @brief 向 out 写入 count 个独立均匀的十进制数位
+     *
+     * 每次从生成器取一个 [0, 10^18) 内的均匀整数，拆成 18 个数位，
+     * 不经过字符串解析。
+     */
+    template <class URBG>
+    void fill_random_digits(int *out, size_t count, URBG &rng)
+    {
+        std::uniform_int_distribution<std::uint64_t> chunk(0, 999999999999999999ULL);
+        for (size_t i = 0; i < count; i += 18)
+        {
+            std::uint64_t v = chunk(rng);
+            const size_t m = std::min<size_t>(18, count - i);
+            for (size_t j = 0; j < m; ++j, v /= 10)
+                out[i + j] = static_cast<int>(v % 10);
+        }
+    }
+} // namespace omniint_detail
+
+/**
+ * @brief [0, 10^n) 内均匀分布的随机数 (可能不足 n 位)
+ */
+template <class URBG>
+OmniInt random_digits(size_t n, URBG &rng)
+{
+    OmniInt result;
+    if (n == 0)
+        return result;
+    omniint_detail::buffer<int> &d = omniint_detail::access::digits(result);
+    d.resize(n);
+    omniint_detail::fill_random_digits(d.data(), n, rng);
+    omniint_detail::access::normalize(result);
+    return result;
+}
+
+/**
+ * @brief [0, bound) 内均匀分布的随机数
+ *
+ * 设 bound 有 d 位，其最高 t = min(d, 18) 位为 top。候选值的高 t 位在 [0, top] 中
+ * 均匀选取，低 d - t 位逐位均匀生成；高位小于 top 时候选值必然小于 bound，
+ * 等于 top 时才需要比较低位，不小于 bound 则重新生成。拒绝的概率不超过 1 / (top + 1)。
+ *
+ * @throw std::invalid_argument bound <= 0
+ */
+template <class URBG>
+OmniInt random_below(const OmniInt &bound, URBG &rng)
+{
+    if (bound < 1)
+        throw std::invalid_argument("random_below bound must be positive");
+    const omniint_detail::buffer<int> &b = omniint_detail::access::digits(bound);
+    const size_t d = b.size(), t = std::min<size_t>(d, 18), low = d - t;
+    std::uint64_t top = 0;
+    for (size_t i = d; i-- > low;)
+        top = top * 10 + static_cast<std::uint64_t>(b[i]);
+
+    OmniInt result;
+    omniint_detail::buffer<int> &r = omniint_detail::access::digits(result);
+    r.resize(d);
+    std::uint64_t c;
+    if (low == 0)
+    {
+        c = std::uniform_int_distribution<std::uint64_t>(0, top - 1)(rng);
+    }
+    else
+    {
+        std::uniform_int_distribution<std::uint64_t> head(0, top);
+        for (;;)
+        {
+            c = head(rng);
+            omniint_detail::fill_random_digits(r.data(), low, rng);
+            if (c < top)
+                break;
+            size_t i = low;
+            while (i > 0 && r[i - 1] == b[i - 1])
+                --i;
+            if (i > 0 && r[i - 1] < b[i - 1])
+                break;
+        }
+    }
+    for (size_t i = low; i < d; ++i, c /= 10)
+        r[i] = static_cast<int>(c % 10);
+    omniint_detail::access::normalize(result);
+    return result;
+}
+
+/**
+ * @brief [0, 2^n) 内均匀分布的随机数
+ *
+ * 2^n 由 cached_power 求出，并按线程记住上一次的 n，批量生成同样位数的随机数时不必重算。
+ */
+template <class URBG>
+OmniInt random_bits(size_t n, URBG &rng)
+{
+    static thread_local size_t cached_n = 0;
+    static thread_local OmniInt cached_bound = 1;
+    if (n != cached_n)
+    {
+        cached_bound = omniint_detail::cached_power(OmniInt(2), n);
+        cached_n = n;
+    }
+    return random_below(cached_bound, rng);
+}
+
+/**
+ * @brief [lo, hi] 内均匀分布的随机数 (包含两端)
+ * @throw std::invalid_argument lo > hi
+ */
+template <class URBG>
+OmniInt random_range(const OmniInt &lo, const OmniInt &hi, URBG &rng)
+{
+    if (lo > hi)
+        throw std::invalid_argument("random_range requires lo <= hi");
+    return lo + random_below(hi - lo + 1, rng);
+}
+
+// --- 使用每个线程的默认生成器 ---
+inline OmniInt random_digits(size_t n) { return random_digits(n, omniint_detail::random_engine()); }
+inline OmniInt random_below(const OmniInt &bound) { return random_below(bound, omniint_detail::random_engine()); }
+inline OmniInt random_bits(size_t n) { return random_bits(n, omniint_detail::random_engine()); }
+inline OmniInt random_range(const OmniInt &lo, const OmniInt &hi)
+{
+    return random_range(lo, hi, omniint_detail::random_engine());
+}
+
+#endif // OmniIntRandom_H
@@ -0,0 +1,191 @@
+/*
+OmniIntSum.h
+
+This is a header file for summing many OmniInt values with deferred
+carry propagation.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniIntSum_H
+#define OmniIntSum_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "OmniInt.h"
+
+/**
+ * @class OmniIntSum
+ * @brief 延迟进位的累加器，用于把大量 OmniInt 累加到同一个总和中。
+ *
+ * OmniInt::operator+= 每次都要完整地传播进位，operator-= 还会调用 trim()。
+ * OmniIntSum 把每一位保存为一个 32 位的"冗余"数位 (carry-save 表示)：累加时只做逐位相加，
+ * 不传播进位；只有在读取、比较或相乘时，或某一位即将溢出时，才统一处理一次进位。
+ * 正数与负数分别累加到两组数位中，读取时再相减。
+ */
+class OmniIntSum
+{
+public:
+    OmniIntSum() : bound_(0) {}
+    explicit OmniIntSum(const OmniInt &initial) : bound_(0) { *this += initial; }
+
+    // =================================================================
+    // Accumulation - 累加
+    // =================================================================
+    OmniIntSum &operator+=(const OmniInt &n)
+    {
+        add(n, omniint_detail::access::is_negative(n) ? negative_ : positive_);
+        return *this;
+    }
+
+    OmniIntSum &operator-=(const OmniInt &n)
+    {
+        add(n, omniint_detail::access::is_negative(n) ? positive_ : negative_);
+        return *this;
+    }
+
+    // 合并另一个累加器的部分和
+    OmniIntSum &operator+=(const OmniIntSum &other)
+    {
+        if (&other == this)
+        {
+            OmniIntSum copy(other);
+            return *this += copy;
+        }
+        if (bound_ > lane_max - other.bound_)
+        {
+            // 合并后可能溢出：先把两边都折叠为规范形式
+            normalize();
+            OmniIntSum normalized(other);
+            normalized.normalize();
+            merge(normalized);
+        }
+        else
+        {
+            merge(other);
+        }
+        return *this;
+    }
+
+    // =================================================================
+    // Reading - 读取 (在此处统一传播进位)
+    // =================================================================
+    OmniInt value() const
+    {
+        return to_omniint(positive_) - to_omniint(negative_);
+    }
+
+    // 把当前总和折叠为规范形式，之后的累加从较小的数位上限重新开始
+    void normalize()
+    {
+        OmniInt total = value();
+        clear();
+        *this += total;
+    }
+
+    void clear()
+    {
+        positive_.clear();
+        negative_.clear();
+        bound_ = 0;
+    }
+
+    int compare(const OmniInt &other) const
+    {
+        OmniInt v = value();
+        return v < other ? -1 : (other < v ? 1 : 0);
+    }
+
+private:
+    typedef std::uint32_t lane;
+    static const std::uint64_t lane_max = std::numeric_limits<lane>::max();
+
+    // 每一位不会超过 bound_；再加一个数字 (最大为 9) 会溢出时先传播进位
+    void add(const OmniInt &n, omniint_detail::buffer<lane> &lanes)
+    {
+        if (n.is_zero())
+            return;
+        if (bound_ + 9 > lane_max)
+        {
+            normalize();
+        }
+        const omniint_detail::buffer<int> &digits = omniint_detail::access::digits(n);
+        if (lanes.size() < digits.size())
+        {
+            lanes.resize(digits.size(), 0);
+        }
+        for (size_t i = 0; i < digits.size(); ++i)
+        {
+            lanes[i] += static_cast<lane>(digits[i]);
+        }
+        bound_ += 9;
+    }
+
+    void merge(const OmniIntSum &other)
+    {
+        merge_lanes(positive_, other.positive_);
+        merge_lanes(negative_, other.negative_);
+        bound_ += other.bound_;
+    }
+
+    static void merge_lanes(omniint_detail::buffer<lane> &lanes, const omniint_detail::buffer<lane> &other)
+    {
+        if (lanes.size() < other.size())
+        {
+            lanes.resize(other.size(), 0);
+        }
+        for (size_t i = 0; i < other.size(); ++i)
+        {
+            lanes[i] += other[i];
+        }
+    }
+
+    static OmniInt to_omniint(const omniint_detail::buffer<lane> &lanes)
+    {
+        OmniInt result;
+        omniint_detail::buffer<int> &digits = omniint_detail::access::digits(result);
+        digits.clear();
+        digits.reserve(lanes.size() + 10);
+        std::uint64_t carry = 0;
+        for (size_t i = 0; i < lanes.size(); ++i)
+        {
+            std::uint64_t total = lanes[i] + carry;
+            digits.push_back(static_cast<int>(total % 10));
+            carry = total / 10;
+        }
+        while (carry > 0)
+        {
+            digits.push_back(static_cast<int>(carry % 10));
+            carry /= 10;
+        }
+        omniint_detail::access::normalize(result);
+        return result;
+    }
+
+    omniint_detail::buffer<lane> positive_; // 正数部分的冗余数位，低位在前
+    omniint_detail::buffer<lane> negative_; // 负数部分 (绝对值) 的冗余数位，低位在前
+    std::uint64_t bound_;        // 任一数位的上限
+};
+
+// =========================================================================
+// Non-Member Functions - 非成员函数
+// =========================================================================
+
+// --- 关系运算符 (先传播进位再比较) ---
+inline bool operator==(const OmniIntSum &lhs, const OmniInt &rhs) { return lhs.compare(rhs) == 0; }
+inline bool operator!=(const OmniIntSum &lhs, const OmniInt &rhs) { return lhs.compare(rhs) != 0; }
+inline bool operator<(const OmniIntSum &lhs, const OmniInt &rhs) { return lhs.compare(rhs) < 0; }
+inline bool operator>(const OmniIntSum &lhs, const OmniInt &rhs) { return lhs.compare(rhs) > 0; }
+inline bool operator<=(const OmniIntSum &lhs, const OmniInt &rhs) { return lhs.compare(rhs) <= 0; }
+inline bool operator>=(const OmniIntSum &lhs, const OmniInt &rhs) { return lhs.compare(rhs) >= 0; }
+
+// --- 乘法 (先传播进位再相乘) ---
+inline OmniInt operator*(const OmniIntSum &lhs, const OmniInt &rhs) { return lhs.value() * rhs; }
+inline OmniInt operator*(const OmniInt &lhs, const OmniIntSum &rhs) { return lhs * rhs.value(); }
+
+// --- 流运算符 ---
+inline std::ostream &operator<<(std::ostream &os, const OmniIntSum &sum) { return os << sum.value(); }
+
+#endif // OmniIntSum_H
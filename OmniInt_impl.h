@@ -0,0 +1,2482 @@
+/*
+OmniInt_impl.h
+
+This is the implementation of OmniInt.h.
+
+In header-only mode it is included by OmniInt.h and every definition is inline.
+When OMNIINT_COMPILED_LIB is defined it is compiled once by OmniInt.cpp instead.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniInt_impl_H
+#define OmniInt_impl_H
+
+#include "OmniInt.h"
+
+#ifdef OMNIINT_COMPILED_LIB
+#define OMNIINT_INLINE
+#else
+#define OMNIINT_INLINE inline
+#endif
+
+namespace omniint_detail
+{
+    /**
+     * @brief 朴素乘法内核：out[i + j] += a[i] * b[j]
+     *
+     * 按多项式卷积计算，不处理进位。out 至少需要 na + nb 个元素。
+     */
+    template <typename T>
+    inline void mul_schoolbook(const T *a, size_t na, const T *b, size_t nb, long long *out)
+    {
+        for (size_t i = 0; i < na; ++i)
+        {
+            const long long ai = a[i];
+            if (ai == 0)
+                continue;
+            for (size_t j = 0; j < nb; ++j)
+            {
+                out[i + j] += ai * b[j];
+            }
+        }
+    }
+
+    /**
+     * @brief Karatsuba 乘法内核：out += a * b (按多项式卷积，不处理进位)
+     *
+     * 把两个乘数各拆成高低两半，用 3 次子乘法代替 4 次。中间结果的系数会随
+     * 递归层数增长，因此统一使用 long long 保存。
+     */
+    template <typename T>
+    inline void mul_karatsuba(const T *a, size_t na, const T *b, size_t nb, long long *out)
+    {
+        if (na < nb)
+        {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        if (nb < OMNIINT_KARATSUBA_THRESHOLD)
+        {
+            mul_schoolbook(a, na, b, nb, out);
+            return;
+        }
+
+        const size_t m = (na + 1) / 2;
+        if (nb <= m)
+        {
+            // 长度悬殊：把较长的乘数切成与较短乘数等长的块，每块都做平衡的乘法。
+            // 若按一半一半拆分，块长会落在 (nb, 2nb] 之间，Karatsuba 拆分后两半长度不等。
+            // 下面的平衡拆分要求 nb > m，否则 z1 的 2m 列会超出 out 的 na + nb 列
+            const size_t chunks = (na + nb - 1) / nb;
+            progress_slices slices(chunks);
+            for (size_t offset = 0; offset < na; offset += nb)
+            {
+                mul_karatsuba(a + offset, std::min(nb, na - offset), b, nb, out + offset);
+                slices.next();
+            }
+            return;
+        }
+
+        // a = a0 + a1 * x^m, b = b0 + b1 * x^m
+        const size_t na1 = na - m, nb1 = nb - m;
+        buffer<long long> sa(a, a + m), sb(b, b + m);
+        for (size_t i = 0; i < na1; ++i)
+            sa[i] += a[m + i];
+        for (size_t i = 0; i < nb1; ++i)
+            sb[i] += b[m + i];
+
+        buffer<long long> z0(2 * m, 0), z2(na1 + nb1, 0), z1(2 * m, 0);
+        progress_slices slices(3);
+        mul_karatsuba(a, m, b, m, z0.data());
+        slices.next();
+        mul_karatsuba(a + m, na1, b + m, nb1, z2.data());
+        slices.next();
+        mul_karatsuba(sa.data(), m, sb.data(), m, z1.data());
+        slices.next();
+
+        // z1 = (a0 + a1)(b0 + b1) - z0 - z2
+        for (size_t i = 0; i < z0.size(); ++i)
+            z1[i] -= z0[i];
+        for (size_t i = 0; i < z2.size(); ++i)
+            z1[i] -= z2[i];
+
+        for (size_t i = 0; i < z0.size(); ++i)
+            out[i] += z0[i];
+        for (size_t i = 0; i < z1.size(); ++i)
+            out[m + i] += z1[i];
+        for (size_t i = 0; i < z2.size(); ++i)
+            out[2 * m + i] += z2[i];
+    }
+
+    // =====================================================================
+    // Number Theoretic Transform - 数论变换
+    // =====================================================================
+    // 在模 p = 2^64 - 2^32 + 1 的整数环上做循环卷积。每 4 个十进制数位打包成一个
+    // 万进制系数，卷积的每个系数不超过 min(la, lb) * 9999^2，远小于 p，因此模 p 的
+    // 结果就是精确的卷积。p - 1 含因子 2^32，变换长度最多为 2^32。
+    namespace ntt
+    {
+        const std::uint64_t modulus = 0xFFFFFFFF00000001ULL;
+        const std::uint64_t generator = 7; // 模 p 的原根
+        const size_t limb_digits = 4;       // 每个系数打包的十进制位数
+        const unsigned max_log_length = 32;
+
+        // 以下运算的操作数是随机的，条件分支几乎无法预测，因此都用掩码写成无分支的形式
+        inline std::uint64_t mask(bool condition) { return 0 - static_cast<std::uint64_t>(condition); }
+
+        inline std::uint64_t add(std::uint64_t a, std::uint64_t b)
+        {
+            std::uint64_t r = a + b;
+            // 溢出时加上 2^64 mod p = 2^32 - 1
+            r += mask(r < a) & 0xFFFFFFFFULL;
+            return r - (mask(r >= modulus) & modulus);
+        }
+
+        inline std::uint64_t sub(std::uint64_t a, std::uint64_t b)
+        {
+            return a - b + (mask(a < b) & modulus);
+        }
+
+        inline std::uint64_t mul(std::uint64_t a, std::uint64_t b)
+        {
+            std::uint64_t lo, hi;
+#if defined(__SIZEOF_INT128__)
+            const unsigned __int128 x = static_cast<unsigned __int128>(a) * b;
+            lo = static_cast<std::uint64_t>(x);
+            hi = static_cast<std::uint64_t>(x >> 64);
+#else
+            const std::uint64_t a0 = a & 0xFFFFFFFFULL, a1 = a >> 32;
+            const std::uint64_t b0 = b & 0xFFFFFFFFULL, b1 = b >> 32;
+            const std::uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+            const std::uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFFULL) + (p10 & 0xFFFFFFFFULL);
+            lo = (p00 & 0xFFFFFFFFULL) | (mid << 32);
+            hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+#endif
+            // x = lo + hi_lo * 2^64 + hi_hi * 2^96，其中 2^64 = 2^32 - 1，2^96 = -1 (mod p)
+            const std::uint64_t hi_lo = hi & 0xFFFFFFFFULL, hi_hi = hi >> 32;
+            std::uint64_t t = lo - hi_hi;
+            t -= mask(lo < hi_hi) & 0xFFFFFFFFULL;
+            const std::uint64_t u = hi_lo * 0xFFFFFFFFULL;
+            std::uint64_t r = t + u;
+            r += mask(r < u) & 0xFFFFFFFFULL;
+            return r - (mask(r >= modulus) & modulus);
+        }
+
+        inline std::uint64_t power(std::uint64_t base, std::uint64_t exponent)
+        {
+            std::uint64_t result = 1;
+            for (; exponent > 0; exponent >>= 1)
+            {
+                if (exponent & 1)
+                    result = mul(result, base);
+                base = mul(base, base);
+            }
+            return result;
+        }
+
+        inline size_t limbs_for(size_t digits) { return (digits + limb_digits - 1) / limb_digits; }
+
+        /**
+         * @brief 给定长度 n 的变换中，预先计算好的单位根表
+         *
+         * 正变换按频率抽取 (输入自然顺序，输出位反转顺序)，逆变换按时间抽取
+         * (输入位反转顺序，输出自然顺序)，两者之间的逐点乘法不关心顺序，因此省去了位反转。
+         */
+        struct plan
+        {
+            size_t length;
+            buffer<std::uint64_t> roots;         // roots[j] = w^j，j < n / 2
+            buffer<std::uint64_t> inverse_roots; // inverse_roots[j] = w^-j
+            std::uint64_t length_inverse;
+
+            explicit plan(size_t n) : length(n), roots(n / 2), inverse_roots(n / 2)
+            {
+                unsigned log_n = 0;
+                while ((size_t(1) << log_n) < n)
+                    ++log_n;
+                if (log_n > max_log_length)
+                    throw std::length_error("OmniInt operands too large for NTT multiplication");
+                const std::uint64_t w = power(generator, (modulus - 1) >> log_n);
+                const std::uint64_t w_inverse = power(w, modulus - 2);
+                std::uint64_t x = 1, y = 1;
+                for (size_t j = 0; j < n / 2; ++j)
+                {
+                    roots[j] = x;
+                    inverse_roots[j] = y;
+                    x = mul(x, w);
+                    y = mul(y, w_inverse);
+                }
+                length_inverse = power(n, modulus - 2);
+            }
+
+            void forward(std::uint64_t *a) const
+            {
+                for (size_t half = length / 2, stride = 1; half >= 1; half /= 2, stride *= 2)
+                {
+                    for (size_t i = 0; i < length; i += 2 * half)
+                    {
+                        for (size_t j = 0; j < half; ++j)
+                        {
+                            const std::uint64_t u = a[i + j], v = a[i + j + half];
+                            a[i + j] = add(u, v);
+                            a[i + j + half] = mul(sub(u, v), roots[j * stride]);
+                        }
+                    }
+                }
+            }
+
+            void inverse(std::uint64_t *a) const
+            {
+                for (size_t half = 1, stride = length / 2; half < length; half *= 2, stride /= 2)
+                {
+                    for (size_t i = 0; i < length; i += 2 * half)
+                    {
+                        for (size_t j = 0; j < half; ++j)
+                        {
+                            const std::uint64_t u = a[i + j], v = mul(a[i + j + half], inverse_roots[j * stride]);
+                            a[i + j] = add(u, v);
+                            a[i + j + half] = sub(u, v);
+                        }
+                    }
+                }
+                for (size_t i = 0; i < length; ++i)
+                    a[i] = mul(a[i], length_inverse);
+            }
+        };
+
+        // 把 count 个十进制数位打包为万进制系数，其余位置补零，共 n 个系数
+        inline void pack(const int *digits, size_t count, std::uint64_t *limbs, size_t n)
+        {
+            size_t k = 0;
+            for (size_t i = 0; i < count; i += limb_digits, ++k)
+            {
+                std::uint64_t limb = 0;
+                for (size_t j = std::min(count, i + limb_digits); j > i; --j)
+                    limb = limb * 10 + digits[j - 1];
+                limbs[k] = limb;
+            }
+            std::fill(limbs + k, limbs + n, 0);
+        }
+
+        /**
+         * @brief 与一个已变换、有 transformed_digits 位的乘数相乘时使用的变换长度
+         *
+         * 另一个乘数不超过它的两倍长时整体相乘；否则把另一个乘数切块，
+         * 长度取能容纳两倍于已变换乘数的最小 2 的幂。
+         */
+        inline size_t length_for(size_t other_digits, size_t transformed_digits)
+        {
+            const size_t lb = limbs_for(transformed_digits);
+            const size_t limbs = other_digits >= 2 * transformed_digits ? 2 * lb : limbs_for(other_digits) + lb - 1;
+            size_t n = 1;
+            while (n < limbs)
+                n *= 2;
+            return n;
+        }
+
+        // 位数为 na、nb 的乘法所需的变换长度不超过 2^max_log_length 时才能使用 NTT
+        inline bool fits(size_t na, size_t nb)
+        {
+            const size_t n = length_for(std::max(na, nb), std::min(na, nb));
+            unsigned log_n = 0;
+            while ((size_t(1) << log_n) < n)
+                ++log_n;
+            return log_n <= max_log_length;
+        }
+
+        /**
+         * @brief out += a * b，其中 b 已按 p 变换为 fb，共 lb 个系数
+         *
+         * a 被切成若干块，每块与 b 的卷积恰好放得进长度 p.length 的循环卷积中。
+         * 结果的第 k 个万进制系数累加到 out 的第 4k 列上，out 至少需要 na + nb 个元素。
+         */
+        inline void multiply_transformed(const int *a, size_t na, const std::uint64_t *fb, size_t lb,
+                                         const plan &p, long long *out)
+        {
+            const size_t chunk = limb_digits * (p.length - lb + 1);
+            buffer<std::uint64_t> work(p.length);
+            progress_slices slices((na + chunk - 1) / chunk);
+            for (size_t offset = 0; offset < na; offset += chunk)
+            {
+                const size_t count = std::min(chunk, na - offset);
+                pack(a + offset, count, work.data(), p.length);
+                p.forward(work.data());
+                for (size_t i = 0; i < p.length; ++i)
+                    work[i] = mul(work[i], fb[i]);
+                p.inverse(work.data());
+                const size_t limbs = limbs_for(count) + lb - 1;
+                for (size_t k = 0; k < limbs; ++k)
+                    out[offset + limb_digits * k] += static_cast<long long>(work[k]);
+                slices.next();
+            }
+        }
+    } // namespace ntt
+
+    /**
+     * @brief NTT 乘法内核：out += a * b
+     *
+     * 与 Karatsuba 内核不同，结果按万进制系数累加 (只写入下标为 4 的倍数的列)，
+     * 因此只适用于原始的十进制数位，且只能用于不关心各列具体分布的完整乘积。
+     * 长度悬殊时较短的乘数只变换一次，较长的乘数按块复用它。
+     */
+    inline void mul_ntt(const int *a, size_t na, const int *b, size_t nb, long long *out)
+    {
+        if (na < nb)
+        {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        const ntt::plan p(ntt::length_for(na, nb));
+        buffer<std::uint64_t> fb(p.length);
+        ntt::pack(b, nb, fb.data(), p.length);
+        p.forward(fb.data());
+        ntt::multiply_transformed(a, na, fb.data(), ntt::limbs_for(nb), p, out);
+    }
+
+    // =====================================================================
+    // Floating-Point FFT - 浮点 FFT
+    // =====================================================================
+    // 用双精度复数 FFT 计算卷积，每 2 ~ 3 个十进制数位打包成一个实系数。长度为 n 的实序列
+    // 把偶数项放在实部、奇数项放在虚部，只需做一次长度 n / 2 的复数变换。
+    //
+    // 只有在舍入误差的先验上界 (Percival, 2003) 小于 1/2 时才使用 FFT，此时把结果
+    // 四舍五入到最近的整数一定得到精确的卷积；否则减少每个系数的位数，只能每位一个
+    // 系数时交给 NTT (此时 NTT 每个系数 4 位，更快)。实部与虚部分开存放，内层循环是
+    // 连续的，用 -march 编译时可被自动向量化。
+    namespace fft
+    {
+        const double pi = 3.14159265358979323846;
+
+        /**
+         * @brief 各级蝶形运算使用的单位根: 半长为 h 的一级使用 exp(i * pi * j / h)，j < h，
+         * 存放在下标 h - 1 开始的位置上。单位根与变换长度无关，每个线程缓存一份最长的表。
+         */
+        struct twiddles
+        {
+            std::vector<double> re, im;
+        };
+
+        inline const twiddles &twiddles_for(size_t length)
+        {
+            static thread_local twiddles table;
+            if (table.re.size() + 1 < length)
+            {
+                table.re.resize(length - 1);
+                table.im.resize(length - 1);
+                for (size_t half = 1; half < length; half *= 2)
+                {
+                    for (size_t j = 0; j < half; ++j)
+                    {
+                        const double angle = pi * static_cast<double>(j) / static_cast<double>(half);
+                        table.re[half - 1 + j] = std::cos(angle);
+                        table.im[half - 1 + j] = std::sin(angle);
+                    }
+                }
+            }
+            return table;
+        }
+
+        /**
+         * @brief 长度为 2^log_n、系数不超过 limb_max 时，卷积的舍入误差是否一定小于 1/2
+         *
+         * |误差| < |a|·|b|·((1+e)^(3n) (1+e√5)^(3n+1) (1+b)^(3n) - 1)，其中 |a|·|b| ≤ limb_max^2 · 2^n，
+         * e = 2^-53，b 为单位根的误差，这里按 8e 估计；n 额外加 2 级，作为实数变换前后处理的余量。
+         */
+        inline bool exact(unsigned log_n, double limb_max)
+        {
+            const double eps = std::ldexp(1.0, -53), beta = 8 * eps;
+            const double n = log_n + 2;
+            const double growth = std::expm1(3 * n * std::log1p(eps) + (3 * n + 1) * std::log1p(eps * std::sqrt(5.0)) +
+                                             3 * n * std::log1p(beta));
+            return limb_max * limb_max * std::ldexp(1.0, static_cast<int>(log_n)) * growth < 0.5;
+        }
+
+        inline size_t limbs_for(size_t digits, size_t limb_digits) { return (digits + limb_digits - 1) / limb_digits; }
+
+        /**
+         * @brief 为位数为 na、nb 的乘法选择每个系数的位数与 (实序列的) 变换长度
+         * @return 每个系数的位数；返回 0 表示误差上界不允许使用 FFT
+         */
+        inline size_t choose(size_t na, size_t nb, size_t &length)
+        {
+            static const double limb_max[] = {0, 9, 99, 999};
+            for (size_t digits = 3; digits >= 2; --digits)
+            {
+                const size_t limbs = limbs_for(na, digits) + limbs_for(nb, digits) - 1;
+                unsigned log_n = 2;
+                length = 4;
+                while (length < limbs)
+                {
+                    length *= 2;
+                    ++log_n;
+                }
+                if (log_n < 63 && exact(log_n, limb_max[digits]))
+                    return digits;
+            }
+            return 0;
+        }
+
+        inline bool usable(size_t na, size_t nb)
+        {
+            size_t length;
+            return choose(na, nb, length) != 0;
+        }
+
+        // 按频率抽取的复数正变换，输出为位反转顺序
+        inline void forward(double *re, double *im, size_t length, const twiddles &w)
+        {
+            for (size_t half = length / 2; half >= 1; half /= 2)
+            {
+                const double *wr = w.re.data() + half - 1, *wi = w.im.data() + half - 1;
+                for (size_t i = 0; i < length; i += 2 * half)
+                {
+                    double *xr = re + i, *xi = im + i, *yr = re + i + half, *yi = im + i + half;
+                    for (size_t j = 0; j < half; ++j)
+                    {
+                        const double dr = xr[j] - yr[j], di = xi[j] - yi[j];
+                        xr[j] += yr[j];
+                        xi[j] += yi[j];
+                        // 乘以 exp(-i * pi * j / half)
+                        yr[j] = dr * wr[j] + di * wi[j];
+                        yi[j] = di * wr[j] - dr * wi[j];
+                    }
+                }
+            }
+        }
+
+        // 按时间抽取的复数逆变换 (不含 1/n 的缩放)，输入为位反转顺序
+        inline void inverse(double *re, double *im, size_t length, const twiddles &w)
+        {
+            for (size_t half = 1; half < length; half *= 2)
+            {
+                const double *wr = w.re.data() + half - 1, *wi = w.im.data() + half - 1;
+                for (size_t i = 0; i < length; i += 2 * half)
+                {
+                    double *xr = re + i, *xi = im + i, *yr = re + i + half, *yi = im + i + half;
+                    for (size_t j = 0; j < half; ++j)
+                    {
+                        // 乘以 exp(i * pi * j / half)
+                        const double vr = yr[j] * wr[j] - yi[j] * wi[j];
+                        const double vi = yr[j] * wi[j] + yi[j] * wr[j];
+                        yr[j] = xr[j] - vr;
+                        yi[j] = xi[j] - vi;
+                        xr[j] += vr;
+                        xi[j] += vi;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief 对位反转顺序下长度为 m 的数组，依次给出每一对频率 (k, m - k) 的位置 (p, q)
+         *
+         * 位置 p 上是频率 rev(p)。对 p ∈ [2^t, 2^(t+1))，频率 m - rev(p) 位于 3 * 2^t - 1 - p。
+         * fn(p, q, k) 对每对位置只调用一次 (p ≤ q)，位置 0 (频率 0 与 m) 需单独处理。
+         */
+        template <typename Fn>
+        inline void for_each_pair(size_t m, Fn fn)
+        {
+            size_t k = 0;
+            for (size_t block = 1; block < m; block *= 2)
+            {
+                for (size_t p = block; p < 2 * block; ++p)
+                {
+                    // k = rev(p)：位反转意义下的加一
+                    size_t bit = m / 2;
+                    while (k & bit)
+                    {
+                        k ^= bit;
+                        bit /= 2;
+                    }
+                    k |= bit;
+                    const size_t q = 3 * block - 1 - p;
+                    if (p <= q)
+                        fn(p, q, k);
+                }
+            }
+        }
+
+        /**
+         * @brief 长度为 2m 的实序列的变换
+         *
+         * 把 digits 打包后的系数按偶数项、奇数项放入 re、im (各 m 个)，做复数变换后
+         * 还原出实序列的频谱 Y[k] (0 ≤ k < m，位反转顺序)。Y[0] 与 Y[m] 都是实数，
+         * 分别放在位置 0 的实部与虚部。
+         */
+        inline void real_forward(const int *digits, size_t count, size_t limb_digits,
+                                 double *re, double *im, size_t m, const twiddles &w)
+        {
+            std::fill(re, re + m, 0.0);
+            std::fill(im, im + m, 0.0);
+            size_t t = 0;
+            for (size_t i = 0; i < count; i += limb_digits, ++t)
+            {
+                int limb = 0;
+                for (size_t j = std::min(count, i + limb_digits); j > i; --j)
+                    limb = limb * 10 + digits[j - 1];
+                (t % 2 == 0 ? re : im)[t / 2] = limb;
+            }
+            forward(re, im, m, w);
+
+            // Z = E + iO，E、O 分别是偶数项与奇数项的频谱；Y[k] = E[k] + w^k O[k]，w = exp(-i * pi / m)
+            const double *wr = w.re.data() + m - 1, *wi = w.im.data() + m - 1;
+            const double e0 = re[0], o0 = im[0];
+            re[0] = e0 + o0;
+            im[0] = e0 - o0;
+            for_each_pair(m, [&](size_t p, size_t q, size_t k)
+                          {
+                // E[k] = (Z[k] + conj Z[m-k]) / 2，O[k] = (Z[k] - conj Z[m-k]) / 2i
+                const double er = (re[p] + re[q]) / 2, ei = (im[p] - im[q]) / 2;
+                const double or_ = (im[p] + im[q]) / 2, oi = (re[q] - re[p]) / 2;
+                // t = w^k O[k]，w^k = cos - i sin
+                const double tr = or_ * wr[k] + oi * wi[k], ti = oi * wr[k] - or_ * wi[k];
+                // Y[k] = E + t，Y[m-k] = conj(E - t)
+                re[p] = er + tr;
+                im[p] = ei + ti;
+                re[q] = er - tr;
+                im[q] = ti - ei; });
+        }
+
+        /**
+         * @brief 与已变换的频谱 (xr, xi) 逐点相乘后做逆变换，把长度为 2m 的实卷积的前 limbs 项
+         * 四舍五入后累加到 out 的第 limb_digits * k 列。(yr, yi) 是 real_forward 的结果，会被覆盖。
+         */
+        inline void real_multiply_inverse(const double *xr, const double *xi, double *yr, double *yi, size_t m,
+                                          const twiddles &w, size_t limbs, size_t limb_digits, long long *out)
+        {
+            const double *wr = w.re.data() + m - 1, *wi = w.im.data() + m - 1;
+            // 位置 0：P[0] 与 P[m] 都是实数；E[0] = (P[0] + P[m]) / 2，O[0] = (P[0] - P[m]) / 2
+            const double p0 = xr[0] * yr[0], pm = xi[0] * yi[0];
+            yr[0] = (p0 + pm) / 2;
+            yi[0] = (p0 - pm) / 2;
+            for_each_pair(m, [&](size_t p, size_t q, size_t k)
+                          {
+                const double pr = xr[p] * yr[p] - xi[p] * yi[p], pi_ = xr[p] * yi[p] + xi[p] * yr[p];
+                const double qr = xr[q] * yr[q] - xi[q] * yi[q], qi = xr[q] * yi[q] + xi[q] * yr[q];
+                // E[k] = (P[k] + conj P[m-k]) / 2，w^k O[k] = (P[k] - conj P[m-k]) / 2
+                const double er = (pr + qr) / 2, ei = (pi_ - qi) / 2;
+                const double tr = (pr - qr) / 2, ti = (pi_ + qi) / 2;
+                // O[k] = conj(w^k) * t，conj(w^k) = cos + i sin
+                const double or_ = tr * wr[k] - ti * wi[k], oi = tr * wi[k] + ti * wr[k];
+                // Z[k] = E + iO，Z[m-k] = conj(E) + i conj(O)
+                yr[p] = er - oi;
+                yi[p] = ei + or_;
+                yr[q] = er + oi;
+                yi[q] = or_ - ei; });
+            inverse(yr, yi, m, w);
+
+            const double scale = 1.0 / static_cast<double>(m);
+            for (size_t t = 0; t < limbs; ++t)
+            {
+                const double value = (t % 2 == 0 ? yr : yi)[t / 2];
+                out[limb_digits * t] += std::llround(value * scale);
+            }
+        }
+    } // namespace fft
+
+    /**
+     * @brief 浮点 FFT 乘法内核：out += a * b (按系数累加到第 limb_digits * k 列，限制与 mul_ntt 相同)
+     *
+     * 调用前需要用 fft::usable() 确认误差上界允许使用 FFT。
+     */
+    inline void mul_fft(const int *a, size_t na, const int *b, size_t nb, long long *out)
+    {
+        size_t length;
+        const size_t limb_digits = fft::choose(na, nb, length);
+        const size_t m = length / 2;
+        const fft::twiddles &w = fft::twiddles_for(length);
+
+        buffer<double> ar(m), ai(m), br(m), bi(m);
+        progress_slices slices(3);
+        fft::real_forward(a, na, limb_digits, ar.data(), ai.data(), m, w);
+        slices.next();
+        fft::real_forward(b, nb, limb_digits, br.data(), bi.data(), m, w);
+        slices.next();
+        const size_t limbs = fft::limbs_for(na, limb_digits) + fft::limbs_for(nb, limb_digits) - 1;
+        fft::real_multiply_inverse(ar.data(), ai.data(), br.data(), bi.data(), m, w, limbs, limb_digits, out);
+        slices.next();
+    }
+
+    // operator* 可以使用的乘法内核 (与 OMNIINT_STATS 中的 OmniIntAlgorithm 一一对应)
+    enum class mul_kernel
+    {
+        schoolbook,
+        karatsuba,
+        ntt,
+        fft,
+        ssa
+    };
+
+    // SSA 的逐点乘法递归地调用以下两个函数，定义在 mul_ssa 之后
+    inline mul_kernel mul_algorithm(size_t na, size_t nb, bool allow_ssa);
+    inline void mul_columns(mul_kernel kernel, const int *a, size_t na, const int *b, size_t nb, long long *out);
+
+    // =====================================================================
+    // Schönhage-Strassen Multiplication - Schönhage-Strassen 乘法
+    // =====================================================================
+    // 在环 Z/(B^n + 1) (B = 10^4) 上做长度为 K = 2^k 的循环卷积。环中 B^n = -1，因此
+    // w = B^(2n/K) 是 K 次本原单位根，乘以 w 的幂只是万进制系数的循环移位加取反，
+    // 蝶形运算中没有乘法，也没有浮点误差或多素数 CRT。逐点乘法是 n 个万进制位的
+    // 普通乘法，再按 B^n = -1 约化，位数足够大时递归地使用本算法。
+    //
+    // 环的元素存放为 n + 1 个万进制位 (低位在前)，取值范围 [0, B^n]，最高一位只能是 0 或 1。
+    namespace ssa
+    {
+        const long long base = 10000;
+        const size_t limb_digits = 4;
+
+        // 把 x = 低 n 位 + top * B^n (top 为较小的有符号整数) 约化到 [0, B^n]
+        inline void settle(std::uint32_t *x, size_t n, long long top)
+        {
+            // B^n = -1，x = 低 n 位 - top
+            long long carry = -top;
+            for (size_t i = 0; i < n && carry != 0; ++i)
+            {
+                const long long v = x[i] + carry;
+                carry = (v < 0 ? v - (base - 1) : v) / base;
+                x[i] = static_cast<std::uint32_t>(v - carry * base);
+            }
+            x[n] = 0;
+            if (carry < 0)
+            {
+                // 低 n 位 - B^n = 低 n 位 + 1
+                size_t i = 0;
+                while (i < n && x[i] == base - 1)
+                    x[i++] = 0;
+                if (i < n)
+                    ++x[i];
+                else
+                    x[n] = 1;
+            }
+            else if (carry > 0)
+            {
+                // 低 n 位 + B^n = 低 n 位 - 1；低 n 位为 0 时结果是 -1 = B^n
+                size_t i = 0;
+                while (i < n && x[i] == 0)
+                    ++i;
+                if (i < n)
+                {
+                    --x[i];
+                    std::fill(x, x + i, static_cast<std::uint32_t>(base - 1));
+                }
+                else
+                    x[n] = 1;
+            }
+        }
+
+        // r = a + b (r 可以与 a 或 b 相同)
+        inline void add(std::uint32_t *r, const std::uint32_t *a, const std::uint32_t *b, size_t n)
+        {
+            long long carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const long long v = static_cast<long long>(a[i]) + b[i] + carry;
+                carry = v >= base;
+                r[i] = static_cast<std::uint32_t>(v - carry * base);
+            }
+            settle(r, n, static_cast<long long>(a[n]) + b[n] + carry);
+        }
+
+        // r = a - b (r 可以与 a 或 b 相同)
+        inline void sub(std::uint32_t *r, const std::uint32_t *a, const std::uint32_t *b, size_t n)
+        {
+            long long carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const long long v = static_cast<long long>(a[i]) - b[i] + carry;
+                carry = -static_cast<long long>(v < 0);
+                r[i] = static_cast<std::uint32_t>(v - carry * base);
+            }
+            settle(r, n, static_cast<long long>(a[n]) - b[n] + carry);
+        }
+
+        /**
+         * @brief r = x * B^s，0 <= s < 2n (r 不能与 x 相同)
+         *
+         * x * B^s = (x mod B^(n-s)) * B^s - floor(x / B^(n-s))，s >= n 时再取反。
+         */
+        inline void shift(std::uint32_t *r, const std::uint32_t *x, size_t s, size_t n)
+        {
+            const long long sign = s < n ? 1 : -1;
+            if (s >= n)
+                s -= n;
+            long long carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const long long source = i < s ? -static_cast<long long>(x[n - s + i])
+                                         : i == s ? static_cast<long long>(x[0]) - x[n]
+                                                  : static_cast<long long>(x[i - s]);
+                const long long v = sign * source + carry;
+                carry = (v < 0 ? v - (base - 1) : v) / base;
+                r[i] = static_cast<std::uint32_t>(v - carry * base);
+            }
+            settle(r, n, carry);
+        }
+
+        /**
+         * @brief 变换参数：长度 K = 2^log_k，每块 piece 个万进制位，环 Z/(B^n + 1)
+         */
+        struct plan
+        {
+            unsigned log_k;
+            size_t length; // K
+            size_t piece;  // 每块的万进制位数
+            size_t n;      // 环的万进制位数，是 K/2 的倍数
+
+            // 位数为 na、nb 的乘法：在估计代价最小的 K 上，保证两者的块数之和不超过 K + 1
+            plan(size_t na, size_t nb) : log_k(0), length(0), piece(0), n(0)
+            {
+                const size_t la = (na + limb_digits - 1) / limb_digits, lb = (nb + limb_digits - 1) / limb_digits;
+                double best = 0;
+                for (unsigned k = 1; k < 31 && (size_t(1) << k) <= 2 * (la + lb); ++k)
+                {
+                    const size_t K = size_t(1) << k;
+                    const size_t m = (la + lb + K - 2) / (K - 1);
+                    // 系数 K * c 不超过 K^2 * B^(2m)，需要 B^extra >= K^2
+                    size_t extra = 1;
+                    while (std::pow(static_cast<double>(base), static_cast<double>(extra)) < std::ldexp(1.0, 2 * k))
+                        ++extra;
+                    const size_t step = std::max<size_t>(1, K / 2);
+                    const size_t ring = (2 * m + extra + step - 1) / step * step;
+                    // 蝶形运算约 k * ring，逐点乘法约 ring * log(ring) (常数按实测估计)
+                    const double cost = static_cast<double>(K) * static_cast<double>(ring) *
+                                        (k + 3 * std::log2(static_cast<double>(ring) + 1));
+                    if (n == 0 || cost < best)
+                    {
+                        best = cost;
+                        log_k = k;
+                        length = K;
+                        piece = m;
+                        n = ring;
+                    }
+                }
+            }
+
+            // w^e 对应的移位量 (e 可以为负，按 mod K 处理)
+            size_t root_shift(long long e) const
+            {
+                const long long k = static_cast<long long>(length);
+                return static_cast<size_t>(((e % k) + k) % k) * (2 * n / length);
+            }
+
+            // 按频率抽取的正变换，输出为位反转顺序；elements 中共 K 个元素，每个 n + 1 位
+            void forward(std::uint32_t *elements, std::uint32_t *temp) const
+            {
+                const size_t width = n + 1;
+                for (size_t half = length / 2, stride = 1; half >= 1; half /= 2, stride *= 2)
+                {
+                    for (size_t i = 0; i < length; i += 2 * half)
+                    {
+                        for (size_t j = 0; j < half; ++j)
+                        {
+                            std::uint32_t *x = elements + (i + j) * width, *y = elements + (i + j + half) * width;
+                            sub(temp, x, y, n);
+                            add(x, x, y, n);
+                            shift(y, temp, root_shift(static_cast<long long>(j * stride)), n);
+                        }
+                    }
+                }
+            }
+
+            // 按时间抽取的逆变换 (不含 1/K 的缩放)，输入为位反转顺序
+            void inverse(std::uint32_t *elements, std::uint32_t *temp) const
+            {
+                const size_t width = n + 1;
+                for (size_t half = 1, stride = length / 2; half < length; half *= 2, stride /= 2)
+                {
+                    for (size_t i = 0; i < length; i += 2 * half)
+                    {
+                        for (size_t j = 0; j < half; ++j)
+                        {
+                            std::uint32_t *x = elements + (i + j) * width, *y = elements + (i + j + half) * width;
+                            shift(temp, y, root_shift(-static_cast<long long>(j * stride)), n);
+                            sub(y, x, temp, n);
+                            add(x, x, temp, n);
+                        }
+                    }
+                }
+            }
+
+            // 把十进制数位切成 K 块，每块 piece 个万进制位
+            void split(const int *digits, size_t count, std::uint32_t *elements) const
+            {
+                const size_t width = n + 1;
+                std::fill(elements, elements + length * width, 0);
+                for (size_t i = 0; i < count; i += limb_digits)
+                {
+                    std::uint32_t limb = 0;
+                    for (size_t j = std::min(count, i + limb_digits); j > i; --j)
+                        limb = limb * 10 + static_cast<std::uint32_t>(digits[j - 1]);
+                    const size_t k = i / limb_digits;
+                    elements[k / piece * width + k % piece] = limb;
+                }
+            }
+        };
+
+        /**
+         * @brief 环上的逐点乘法 a = a * b，复用的缓冲区放在一起以免反复分配
+         */
+        struct pointwise
+        {
+            size_t n;
+            buffer<int> da, db;
+            buffer<long long> columns;
+            buffer<std::uint32_t> product;
+
+            explicit pointwise(size_t ring) : n(ring), da(limb_digits * ring), db(limb_digits * ring),
+                                              columns(2 * limb_digits * ring), product(2 * ring)
+            {
+            }
+
+            // 把 n 个万进制位展开为十进制数位，返回去掉前导零后的位数
+            size_t unpack(const std::uint32_t *x, buffer<int> &digits) const
+            {
+                size_t count = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    std::uint32_t limb = x[i];
+                    for (size_t j = 0; j < limb_digits; ++j, limb /= 10)
+                    {
+                        digits[limb_digits * i + j] = static_cast<int>(limb % 10);
+                        if (limb % 10 != 0)
+                            count = limb_digits * i + j + 1;
+                    }
+                }
+                return count;
+            }
+
+            void multiply(std::uint32_t *a, const std::uint32_t *b, std::uint32_t *temp, size_t shorter)
+            {
+                // B^n = -1，乘以它只需取反
+                if (b[n] != 0)
+                {
+                    std::copy(a, a + n + 1, temp);
+                    shift(a, temp, n, n);
+                    return;
+                }
+                if (a[n] != 0)
+                {
+                    shift(a, b, n, n);
+                    return;
+                }
+                const size_t na = unpack(a, da), nb = unpack(b, db);
+                if (na == 0 || nb == 0)
+                {
+                    std::fill(a, a + n + 1, 0);
+                    return;
+                }
+                std::fill(columns.data(), columns.data() + na + nb, 0);
+                // 只有规模至少减半时才递归，保证递归很快终止
+                mul_columns(mul_algorithm(na, nb, 2 * std::max(na, nb) <= shorter), da.data(), na, db.data(), nb,
+                            columns.data());
+
+                std::fill(product.data(), product.data() + 2 * n, 0);
+                long long carry = 0;
+                for (size_t i = 0; i < na + nb || carry != 0; ++i)
+                {
+                    const long long total = (i < na + nb ? columns[i] : 0) + carry;
+                    carry = total / 10;
+                    static const std::uint32_t scale[] = {1, 10, 100, 1000};
+                    product[i / limb_digits] += static_cast<std::uint32_t>(total % 10) * scale[i % limb_digits];
+                }
+                // 低 n 位 - 高 n 位
+                carry = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const long long v = static_cast<long long>(product[i]) - product[n + i] + carry;
+                    carry = -static_cast<long long>(v < 0);
+                    a[i] = static_cast<std::uint32_t>(v - carry * base);
+                }
+                settle(a, n, carry);
+            }
+        };
+    } // namespace ssa
+
+    /**
+     * @brief Schönhage-Strassen 乘法内核：out += a * b (按万进制系数累加到第 4k 列，限制与 mul_ntt 相同)
+     *
+     * 两个乘数是同一段数位时 (平方) 只做一次正变换。
+     */
+    inline void mul_ssa(const int *a, size_t na, const int *b, size_t nb, long long *out)
+    {
+        const ssa::plan p(na, nb);
+        const size_t width = p.n + 1;
+        const bool square = a == b && na == nb;
+        buffer<std::uint32_t> fa(p.length * width), fb(square ? 0 : p.length * width), temp(width);
+        progress_slices slices(4);
+
+        p.split(a, na, fa.data());
+        p.forward(fa.data(), temp.data());
+        slices.next();
+        if (!square)
+        {
+            p.split(b, nb, fb.data());
+            p.forward(fb.data(), temp.data());
+        }
+        slices.next();
+        ssa::pointwise pointwise(p.n);
+        const std::uint32_t *gb = square ? fa.data() : fb.data();
+        for (size_t i = 0; i < p.length; ++i)
+            pointwise.multiply(fa.data() + i * width, gb + i * width, temp.data(), std::min(na, nb));
+        slices.next();
+        p.inverse(fa.data(), temp.data());
+
+        // 第 i 个元素是 K 乘以卷积的第 i 个系数 (小于 B^n，不会被环约化)，整除 K 后累加
+        const size_t total = na + nb;
+        for (size_t i = 0; i < p.length; ++i)
+        {
+            std::uint32_t *c = fa.data() + i * width;
+            unsigned long long remainder = 0;
+            for (size_t j = p.n; j-- > 0;)
+            {
+                const unsigned long long v = remainder * ssa::base + c[j];
+                c[j] = static_cast<std::uint32_t>(v >> p.log_k);
+                remainder = v & (p.length - 1);
+            }
+            for (size_t j = 0; j < p.n; ++j)
+            {
+                const size_t column = ssa::limb_digits * (i * p.piece + j);
+                if (column >= total)
+                    break;
+                out[column] += c[j];
+            }
+        }
+        slices.next();
+    }
+
+    /**
+     * @brief 为位数为 na、nb 的乘数选择 operator* 使用的算法
+     *
+     * FFT 在阈值以上且误差上界允许时优先；否则在 SSA 阈值以上、或 NTT 的变换长度不够时
+     * 使用 SSA。allow_ssa 为 false 时不选 SSA (SSA 的逐点乘法递归时使用)。
+     */
+    inline mul_kernel mul_algorithm(size_t na, size_t nb, bool allow_ssa = true)
+    {
+        const size_t shorter = std::min(na, nb);
+        if (shorter >= OMNIINT_FFT_THRESHOLD && fft::usable(na, nb))
+            return mul_kernel::fft;
+        if (allow_ssa && (shorter >= OMNIINT_SSA_THRESHOLD ||
+                          (shorter >= OMNIINT_NTT_THRESHOLD && !ntt::fits(na, nb))))
+            return mul_kernel::ssa;
+        if (shorter >= OMNIINT_NTT_THRESHOLD)
+            return mul_kernel::ntt;
+        return shorter >= OMNIINT_KARATSUBA_THRESHOLD ? mul_kernel::karatsuba : mul_kernel::schoolbook;
+    }
+
+    /**
+     * @brief out += a * b，使用 mul_algorithm() 选出的内核
+     *
+     * 使用 FFT、NTT 或 SSA 时结果按系数累加到部分列上，只适用于完整乘积 (见 uses_transform)。
+     */
+    inline void mul_columns(mul_kernel kernel, const int *a, size_t na, const int *b, size_t nb, long long *out)
+    {
+        switch (kernel)
+        {
+        case mul_kernel::fft:
+            mul_fft(a, na, b, nb, out);
+            break;
+        case mul_kernel::ssa:
+            mul_ssa(a, na, b, nb, out);
+            break;
+        case mul_kernel::ntt:
+            mul_ntt(a, na, b, nb, out);
+            break;
+        default:
+            mul_karatsuba(a, na, b, nb, out);
+            break;
+        }
+    }
+
+    // operator* 是否会对位数为 na、nb 的乘数使用 FFT、NTT 或 SSA
+    inline bool uses_transform(size_t na, size_t nb)
+    {
+        const mul_kernel kernel = mul_algorithm(na, nb);
+        return kernel != mul_kernel::karatsuba && kernel != mul_kernel::schoolbook;
+    }
+
+    /**
+     * @brief 截断乘法内核：只计算卷积的低 n 列，out[c] += sum(a[i] * b[c - i]) (c < n)
+     *
+     * 按 Mulders 的方法把乘数在 m (约 0.7n) 处拆开：低半部分做完整乘法，
+     * 两个交叉项递归地只计算低 n - m 列，高半部分的乘积全部落在 n 列以外，直接省略。
+     */
+    template <typename T>
+    inline void mul_low_columns(const T *a, size_t na, const T *b, size_t nb, size_t n, long long *out)
+    {
+        na = std::min(na, n);
+        nb = std::min(nb, n);
+        if (na == 0 || nb == 0)
+            return;
+        if (na < nb)
+        {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        if (na + nb <= n)
+        {
+            // 完整的乘积都落在 n 列以内
+            mul_karatsuba(a, na, b, nb, out);
+            return;
+        }
+        if (nb < OMNIINT_KARATSUBA_THRESHOLD)
+        {
+            for (size_t i = 0; i < na; ++i)
+            {
+                const long long ai = a[i];
+                const size_t limit = std::min(nb, n - i);
+                for (size_t j = 0; j < limit; ++j)
+                {
+                    out[i + j] += ai * b[j];
+                }
+            }
+            return;
+        }
+
+        const size_t m = std::max((n + 1) / 2, n * 7 / 10);
+        const size_t na0 = std::min(na, m), nb0 = std::min(nb, m);
+        {
+            buffer<long long> low(na0 + nb0, 0);
+            mul_karatsuba(a, na0, b, nb0, low.data());
+            const size_t count = std::min(low.size(), n);
+            for (size_t c = 0; c < count; ++c)
+                out[c] += low[c];
+        }
+        if (na > m)
+            mul_low_columns(a + m, na - m, b, nb0, n - m, out + m);
+        if (nb > m)
+            mul_low_columns(a, na0, b + m, nb - m, n - m, out + m);
+    }
+
+    // 对卷积结果做进位，得到十进制数位；keep_overflow 为 false 时丢弃超出 count 列的进位
+    inline void carry_columns(const long long *columns, size_t count, buffer<int> &digits, bool keep_overflow)
+    {
+        digits.resize(count);
+        long long carry = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            long long total = columns[i] + carry;
+            digits[i] = static_cast<int>(total % 10);
+            carry = total / 10;
+        }
+        while (keep_overflow && carry > 0)
+        {
+            digits.push_back(static_cast<int>(carry % 10));
+            carry /= 10;
+        }
+        if (digits.empty())
+            digits.push_back(0);
+    }
+
+    // 去掉最低的 count 位 (即除以 10^count)
+    inline void drop_low_digits(OmniInt &n, size_t count)
+    {
+        buffer<int> &digits = access::digits(n);
+        if (count >= digits.size())
+        {
+            digits.assign(1, 0);
+        }
+        else
+        {
+            digits.erase(digits.begin(), digits.begin() + count);
+        }
+        access::normalize(n);
+    }
+} // namespace omniint_detail
+
+// =========================================================================
+// 成员函数 - Member Functions
+// =========================================================================
+
+// --- 构造函数 ---
+OMNIINT_INLINE OmniInt::OmniInt() noexcept : pos(true)
+{
+    val.push_back(0);
+}
+
+OMNIINT_INLINE OmniInt::OmniInt(long long n)
+{
+    if (n == 0)
+    {
+        pos = true;
+        val.push_back(0);
+        return;
+    }
+    pos = (n > 0);
+    unsigned long long mag = (n > 0) ? n : -static_cast<unsigned long long>(n);
+    while (mag > 0)
+    {
+        val.push_back(mag % 10);
+        mag /= 10;
+    }
+}
+
+OMNIINT_INLINE OMNIINT_NOINLINE OmniInt::OmniInt(const std::string &s)
+{
+    if (s.empty() || (s.size() == 1 && (s[0] == '+' || s[0] == '-')))
+    {
+        throw std::invalid_argument("Invalid string for OmniInt");
+    }
+    OMNIINT_STATS_SCOPE(OmniIntAlgorithm::FromString, s.size());
+    OMNIINT_TRACE_SCOPE(OmniIntTraceOp::FromString, s.size(), 0);
+
+    int start = 0;
+    if (s[0] == '-')
+    {
+        pos = false;
+        start = 1;
+    }
+    else if (s[0] == '+')
+    {
+        pos = true;
+        start = 1;
+    }
+    else
+    {
+        pos = true;
+    }
+
+    for (int i = s.size() - 1; i >= start; --i)
+    {
+        if (s[i] < '0' || s[i] > '9')
+        {
+            throw std::invalid_argument("Invalid character in string for OmniInt");
+        }
+        val.push_back(s[i] - '0');
+    }
+
+    trim();
+    if (is_zero())
+    {
+        pos = true;
+    }
+}
+
+OMNIINT_INLINE OmniInt::OmniInt(const OmniInt &other) : val(other.val), pos(other.pos) {}
+
+OMNIINT_INLINE OmniInt::OmniInt(OmniInt &&other) noexcept : val(std::move(other.val)), pos(other.pos)
+{
+    // 将源对象置于有效的空状态
+    other.val.clear();
+    other.val.push_back(0);
+    other.pos = true;
+}
+
+// --- 赋值运算符 ---
+OMNIINT_INLINE OmniInt &OmniInt::operator=(long long n)
+{
+    // 直接调用构造函数和移动赋值，代码复用且安全
+    *this = OmniInt(n);
+    return *this;
+}
+
+OMNIINT_INLINE OmniInt &OmniInt::operator=(const std::string &s)
+{
+    // 构造-移动惯用法
+    OmniInt temp(s);
+    *this = std::move(temp);
+    return *this;
+}
+
+OMNIINT_INLINE OmniInt &OmniInt::operator=(const OmniInt &other)
+{
+    if (this != &other)
+    {
+        val = other.val;
+        pos = other.pos;
+    }
+    return *this;
+}
+
+OMNIINT_INLINE OmniInt &OmniInt::operator=(OmniInt &&other) noexcept
+{
+    if (this != &other)
+    {
+        val = std::move(other.val);
+        pos = other.pos;
+        other.val.clear();
+        other.val.push_back(0);
+        other.pos = true;
+    }
+    return *this;
+}
+
+// --- 一元运算符 ---
+OMNIINT_INLINE OmniInt OmniInt::operator-() const
+{
+    if (is_zero())
+    {
+        return *this;
+    }
+    OmniInt result = *this;
+    result.pos = !pos;
+    return result;
+}
+
+// --- 二元运算符 (调用复合赋值实现) ---
+OMNIINT_INLINE OmniInt OmniInt::operator+(const OmniInt &other) const
+{
+    OmniInt result = *this;
+    result += other;
+    return result;
+}
+
+OMNIINT_INLINE OmniInt OmniInt::operator-(const OmniInt &other) const
+{
+    OmniInt result = *this;
+    result -= other;
+    return result;
+}
+
+OMNIINT_INLINE OmniInt OmniInt::operator*(const OmniInt &other) const
+{
+    OmniInt result = *this;
+    result *= other;
+    return result;
+}
+
+OMNIINT_INLINE OmniInt OmniInt::operator/(const OmniInt &other) const
+{
+    return divide_and_remainder(other).first;
+}
+
+OMNIINT_INLINE OmniInt OmniInt::operator%(const OmniInt &other) const
+{
+    return divide_and_remainder(other).second;
+}
+
+// --- 复合赋值运算符 (就地修改) ---
+OMNIINT_INLINE OmniInt &OmniInt::operator+=(const OmniInt &other)
+{
+    // 加零直接返回；否则负数加零会在 += 与 -= 之间无限递归 (零的符号总是正)
+    if (other.is_zero())
+    {
+        return *this;
+    }
+    if (pos == other.pos)
+    {
+        OMNIINT_STATS_SCOPE(OmniIntAlgorithm::Add, std::max(val.size(), other.val.size()));
+        val.resize(std::max(val.size(), other.val.size()), 0);
+        int carry = 0;
+        for (size_t i = 0; i < val.size(); ++i)
+        {
+            int sum = val[i] + carry + (i < other.val.size() ? other.val[i] : 0);
+            val[i] = sum % 10;
+            carry = sum / 10;
+        }
+        if (carry)
+        {
+            val.push_back(carry);
+        }
+    }
+    else
+    {
+        *this -= (-other);
+    }
+    return *this;
+}
+
+OMNIINT_INLINE OmniInt &OmniInt::operator-=(const OmniInt &other)
+{
+    if (other.is_zero())
+    {
+        return *this;
+    }
+    if (pos != other.pos)
+    {
+        *this += (-other);
+        return *this;
+    }
+
+    if (abs() < other.abs())
+    {
+        *this = -(other - *this);
+        return *this;
+    }
+
+    OMNIINT_STATS_SCOPE(OmniIntAlgorithm::Subtract, val.size());
+    int borrow = 0;
+    for (size_t i = 0; i < val.size(); ++i)
+    {
+        int diff = val[i] - borrow - (i < other.val.size() ? other.val[i] : 0);
+        if (diff < 0)
+        {
+            diff += 10;
+            borrow = 1;
+        }
+        else
+        {
+            borrow = 0;
+        }
+        val[i] = diff;
+    }
+    trim();
+    if (is_zero())
+    {
+        pos = true;
+    }
+    return *this;
+}
+
+OMNIINT_INLINE OMNIINT_NOINLINE OmniInt &OmniInt::operator*=(const OmniInt &other)
+{
+    // 处理任意一方为零的平凡情况
+    if (this->is_zero() || other.is_zero())
+    {
+        *this = 0;
+        return *this;
+    }
+
+    // 1. 准备阶段
+    // 结果的符号由两个操作数的符号决定
+    bool result_pos = (this->pos == other.pos);
+    typedef omniint_detail::mul_kernel mul_kernel;
+    const mul_kernel kernel = omniint_detail::mul_algorithm(val.size(), other.val.size());
+    OMNIINT_STATS_SCOPE(kernel == mul_kernel::fft         ? OmniIntAlgorithm::MulFft
+                        : kernel == mul_kernel::ssa       ? OmniIntAlgorithm::MulSsa
+                        : kernel == mul_kernel::ntt       ? OmniIntAlgorithm::MulNtt
+                        : kernel == mul_kernel::karatsuba ? OmniIntAlgorithm::MulKaratsuba
+                                                          : OmniIntAlgorithm::MulSchoolbook,
+                        std::max(val.size(), other.val.size()));
+    OMNIINT_TRACE_SCOPE(OmniIntTraceOp::Multiply, val.size(), other.val.size());
+    omniint_detail::progress_scope progress(true);
+
+    // 结果的位数最多是两个操作数位数之和，分配足够大的向量
+    // digits 将成为结果的存储，result_val 只是计算过程中的临时数据
+    omniint_detail::buffer<int> digits(this->val.size() + other.val.size());
+    OMNIINT_SCRATCH_SCOPE();
+    omniint_detail::buffer<long long> result_val(digits.size(), 0);
+
+    // 2. 纯乘法累加阶段
+    //   - 把两个操作数视为多项式，将卷积结果累加到 result_val 中
+    //   - 较短的乘数位数达到 OMNIINT_FFT_THRESHOLD 且误差上界允许时使用浮点 FFT，
+    //     达到 OMNIINT_SSA_THRESHOLD (或超出 NTT 的长度上限) 时使用 Schönhage-Strassen，
+    //     达到 OMNIINT_NTT_THRESHOLD 时使用 NTT，达到 OMNIINT_KARATSUBA_THRESHOLD 时使用 Karatsuba，
+    //     否则使用朴素乘法
+    omniint_detail::mul_columns(kernel, this->val.data(), this->val.size(),
+                                other.val.data(), other.val.size(), result_val.data());
+
+    // 3. 进位处理阶段
+    //   - 从低位到高位遍历 result_val
+    //   - 将每一位的数字和来自前一位的进位相加
+    //   - 更新当前位为 total % 10，并计算新的进位 total / 10
+    long long carry = 0;
+    for (size_t i = 0; i < result_val.size(); ++i)
+    {
+        long long total = result_val[i] + carry;
+        digits[i] = static_cast<int>(total % 10);
+        carry = total / 10;
+    }
+
+    // 如果最高位还有进位，将其添加到向量末尾
+    while (carry > 0)
+    {
+        digits.push_back(static_cast<int>(carry % 10));
+        carry /= 10;
+    }
+
+    // 4. 收尾阶段
+    // 将计算好的结果更新到 this 对象
+    this->val = std::move(digits);
+    this->pos = result_pos;
+
+    // 调用 trim() 移除可能存在的前导零 (在 vector 中是尾部的零)
+    // 这一步是必要的，因为我们预分配的 result_val 可能比实际结果长
+    this->trim();
+
+    progress.finish();
+    return *this;
+}
+
+OMNIINT_INLINE OmniInt &OmniInt::operator/=(const OmniInt &other)
+{
+    *this = *this / other;
+    return *this;
+}
+
+OMNIINT_INLINE OmniInt &OmniInt::operator%=(const OmniInt &other)
+{
+    *this = *this % other;
+    return *this;
+}
+
+// --- 自增自减 ---
+OMNIINT_INLINE OmniInt &OmniInt::operator++() { return *this += 1; }
+OMNIINT_INLINE OmniInt &OmniInt::operator--() { return *this -= 1; }
+OMNIINT_INLINE OmniInt OmniInt::operator++(int)
+{
+    OmniInt temp = *this;
+    ++*this;
+    return temp;
+}
+OMNIINT_INLINE OmniInt OmniInt::operator--(int)
+{
+    OmniInt temp = *this;
+    --*this;
+    return temp;
+}
+
+// --- 关系运算符 ---
+OMNIINT_INLINE bool OmniInt::operator<(const OmniInt &other) const { return compare(other) == -1; }
+OMNIINT_INLINE bool OmniInt::operator>(const OmniInt &other) const { return compare(other) == 1; }
+OMNIINT_INLINE bool OmniInt::operator<=(const OmniInt &other) const { return compare(other) <= 0; }
+OMNIINT_INLINE bool OmniInt::operator>=(const OmniInt &other) const { return compare(other) >= 0; }
+OMNIINT_INLINE bool OmniInt::operator==(const OmniInt &other) const { return compare(other) == 0; }
+OMNIINT_INLINE bool OmniInt::operator!=(const OmniInt &other) const { return compare(other) != 0; }
+
+// --- 其他成员函数 ---
+OMNIINT_INLINE long long OmniInt::toLongLong() const
+{
+    if (pos)
+    {
+        static const OmniInt llong_max(std::numeric_limits<long long>::max());
+        if (*this > llong_max)
+        {
+            throw std::overflow_error("OmniInt value too large for long long");
+        }
+    }
+    else
+    {
+        static const OmniInt llong_min(std::numeric_limits<long long>::min());
+        if (*this < llong_min)
+        {
+            throw std::overflow_error("OmniInt value too small for long long");
+        }
+    }
+
+    long long result = 0;
+    for (int i = val.size() - 1; i >= 0; --i)
+    {
+        result = result * 10 + val[i];
+    }
+    return pos ? result : -result;
+}
+
+OMNIINT_INLINE OMNIINT_NOINLINE std::string OmniInt::toString() const
+{
+    if (is_zero())
+        return "0";
+    OMNIINT_STATS_SCOPE(OmniIntAlgorithm::ToString, val.size());
+    OMNIINT_TRACE_SCOPE(OmniIntTraceOp::ToString, val.size(), 0);
+    omniint_detail::progress_scope progress;
+    std::string s(val.size() + (pos ? 0 : 1), '-');
+    char *out = &s[pos ? 0 : 1];
+    for (size_t i = val.size(); i-- > 0;)
+    {
+        *out++ = static_cast<char>('0' + val[i]);
+        if ((i & 0xFFFF) == 0)
+            progress.checkpoint(val.size() - i, val.size());
+    }
+    progress.finish();
+    return s;
+}
+
+OMNIINT_INLINE size_t OmniInt::digitCount() const
+{
+    if (is_zero())
+        return 1;
+    return val.size();
+}
+
+OMNIINT_INLINE OmniInt OmniInt::abs() const
+{
+    OmniInt result = *this;
+    result.pos = true;
+    return result;
+}
+
+OMNIINT_INLINE bool OmniInt::is_zero() const
+{
+    return val.size() == 1 && val[0] == 0;
+}
+
+OMNIINT_INLINE bool OmniInt::is_even() const
+{
+    if (is_zero())
+        return true;
+    return val[0] % 2 == 0;
+}
+
+#ifdef OMNIINT_STATS
+OMNIINT_INLINE OmniInt::Stats OmniInt::stats()
+{
+    return omniint_detail::thread_stats();
+}
+
+OMNIINT_INLINE void OmniInt::reset_stats()
+{
+    omniint_detail::thread_stats() = OmniIntStats();
+}
+#endif
+
+#ifdef OMNIINT_TRACE
+OMNIINT_INLINE void OmniInt::set_trace_callback(OmniIntTraceCallback callback)
+{
+    omniint_detail::trace_callback().store(callback, std::memory_order_release);
+}
+#endif
+
+#ifdef OMNIINT_TRACK_MEMORY
+OMNIINT_INLINE OmniInt::MemoryUsage OmniInt::memory_usage()
+{
+    const omniint_detail::memory_counter *counters = omniint_detail::memory_counters();
+    MemoryUsage usage;
+    usage.storage = counters[0].snapshot();
+    usage.scratch = counters[1].snapshot();
+    usage.total = counters[2].snapshot();
+    return usage;
+}
+
+OMNIINT_INLINE void OmniInt::reset_memory_usage()
+{
+    omniint_detail::memory_counter *counters = omniint_detail::memory_counters();
+    for (int i = 0; i < 3; ++i)
+    {
+        counters[i].reset();
+    }
+}
+#endif
+
+// --- 私有辅助函数实现 ---
+OMNIINT_INLINE OMNIINT_NOINLINE std::pair<OmniInt, OmniInt> OmniInt::divide_and_remainder(const OmniInt &divisor) const
+{
+    if (divisor.is_zero())
+    {
+        throw std::runtime_error("Division by zero");
+    }
+    OMNIINT_TRACE_SCOPE(OmniIntTraceOp::Divide, val.size(), divisor.val.size());
+    if (abs() < divisor.abs())
+    {
+        return {OmniInt(0), *this};
+    }
+    OMNIINT_STATS_SCOPE(OmniIntAlgorithm::LongDivision, val.size());
+
+    omniint_detail::progress_scope progress;
+
+    OmniInt abs_this = abs();
+    OmniInt abs_divisor = divisor.abs();
+
+    omniint_detail::buffer<int> quotient_digits;
+    quotient_digits.reserve(abs_this.val.size());
+
+    // 倍数表与试商过程中的余数都是临时数据
+    OMNIINT_SCRATCH_SCOPE();
+    omniint_detail::buffer<OmniInt> multiples(10);
+    for (int i = 1; i <= 9; ++i)
+    {
+        multiples[i] = abs_divisor * i;
+    }
+
+    OmniInt current_remainder = 0;
+
+    for (int i = abs_this.val.size() - 1; i >= 0; --i)
+    {
+        current_remainder = current_remainder * 10 + abs_this.val[i];
+
+        int low = 0, high = 9, digit = 0;
+        while (low <= high)
+        {
+            int mid = (low + high) / 2;
+            if (multiples[mid] <= current_remainder)
+            {
+                digit = mid;
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid - 1;
+            }
+        }
+
+        current_remainder -= multiples[digit];
+        quotient_digits.push_back(digit);
+        progress.checkpoint(abs_this.val.size() - i, abs_this.val.size());
+    }
+
+    OMNIINT_SCRATCH_END();
+
+    OmniInt quotient;
+    std::reverse(quotient_digits.begin(), quotient_digits.end());
+    quotient.val = std::move(quotient_digits);
+    quotient.trim();
+    quotient.pos = (this->pos == divisor.pos);
+    if (quotient.is_zero())
+    {
+        quotient.pos = true;
+    }
+
+    OmniInt remainder = current_remainder;
+    remainder.pos = this->pos;
+    if (remainder.is_zero())
+    {
+        remainder.pos = true;
+    }
+
+    progress.finish();
+    return {quotient, remainder};
+}
+
+OMNIINT_INLINE void OmniInt::trim()
+{
+    while (val.size() > 1 && val.back() == 0)
+    {
+        val.pop_back();
+    }
+}
+
+OMNIINT_INLINE int OmniInt::compare(const OmniInt &other) const
+{
+    if (pos != other.pos)
+    {
+        return pos ? 1 : -1;
+    }
+    if (is_zero() && other.is_zero())
+    {
+        return 0;
+    }
+
+    int sign_multiplier = pos ? 1 : -1;
+
+    if (val.size() < other.val.size())
+        return -1 * sign_multiplier;
+    if (val.size() > other.val.size())
+        return 1 * sign_multiplier;
+
+    for (int i = val.size() - 1; i >= 0; --i)
+    {
+        if (val[i] < other.val[i])
+            return -1 * sign_multiplier;
+        if (val[i] > other.val[i])
+            return 1 * sign_multiplier;
+    }
+    return 0;
+}
+
+OMNIINT_INLINE void OmniInt::halve_in_place()
+{
+    if (is_zero())
+        return;
+    int carry = 0;
+    for (int i = val.size() - 1; i >= 0; --i)
+    {
+        int current_val = val[i] + carry * 10;
+        val[i] = current_val / 2;
+        carry = current_val % 2;
+    }
+    trim();
+}
+
+// =========================================================================
+// 非成员函数 - Non-Member Functions
+// =========================================================================
+
+// --- 流运算符 ---
+OMNIINT_INLINE std::ostream &operator<<(std::ostream &os, const OmniInt &n)
+{
+    if (os.width() != 0)
+    {
+        // 需要按 setw 填充时，整体输出
+        os << n.toString();
+        return os;
+    }
+    if (n.is_zero())
+        return os.put('0');
+    // 否则分块输出，不构造完整的字符串；统计与跟踪按 toString() 计
+    const omniint_detail::buffer<int> &digits = omniint_detail::access::digits(n);
+    OMNIINT_STATS_SCOPE(OmniIntAlgorithm::ToString, digits.size());
+    OMNIINT_TRACE_SCOPE(OmniIntTraceOp::ToString, digits.size(), 0);
+    char chunk[4096];
+    size_t used = 0;
+    if (omniint_detail::access::is_negative(n))
+        chunk[used++] = '-';
+    for (size_t i = digits.size(); i-- > 0 && os;)
+    {
+        chunk[used++] = static_cast<char>('0' + digits[i]);
+        if (used == sizeof(chunk))
+        {
+            os.write(chunk, used);
+            used = 0;
+        }
+    }
+    os.write(chunk, used);
+    return os;
+}
+
+OMNIINT_INLINE std::istream &operator>>(std::istream &is, OmniInt &n)
+{
+    std::string s;
+    if (is >> s)
+    {
+        try
+        {
+            n = s;
+        }
+        catch (const std::invalid_argument &)
+        {
+            // 如果构造失败，设置流的错误状态
+            is.setstate(std::ios_base::failbit);
+        }
+    }
+    return is;
+}
+
+// --- 数学函数 ---
+OMNIINT_INLINE OMNIINT_NOINLINE OmniInt sqrt(const OmniInt &n)
+{
+    if (n < 0)
+    {
+        throw std::domain_error("Cannot compute square root of a negative number.");
+    }
+    if (n.is_zero())
+    {
+        return 0;
+    }
+    OMNIINT_STATS_SCOPE(OmniIntAlgorithm::SqrtNewton, n.digitCount());
+    OMNIINT_TRACE_SCOPE(OmniIntTraceOp::Sqrt, n.digitCount(), 0);
+
+    // 步骤 1: 构造一个绝对可靠的“过高”初始值 (overestimate)
+    // 这是保证后续循环逻辑正确性的关键。
+    // 一个 d 位数 n, 其 sqrt(n) 的位数是 ceil(d/2)。
+    // 我们构造一个比结果多一位的数 10^ceil(d/2)，它必然大于真实的 sqrt(n)。
+    size_t digits = n.digitCount();
+    size_t root_exponent = (digits + 1) / 2;
+    std::string guess_str(root_exponent + 1, '0');
+    guess_str[0] = '1';
+    OmniInt x(guess_str);
+
+    // 步骤 2: 牛顿迭代。由于初始值 x 保证偏高，迭代序列将稳定单调递减。
+    // 迭代次数约为 log2(位数) 加上常数，进度按此估计
+    omniint_detail::progress_scope progress;
+    size_t iterations = 0, expected_iterations = 8;
+    for (size_t d = digits; d > 1; d /= 2)
+        ++expected_iterations;
+    OmniInt last_x;
+    do
+    {
+        last_x = x;
+        x = (x + n / x) / 2;
+        ++iterations;
+        progress.checkpoint(std::min(iterations, expected_iterations - 1), expected_iterations);
+    } while (x < last_x);
+
+    // 步骤 3: 循环结束时，last_x 是最接近真实根的候选值
+    x = last_x;
+
+    // 步骤 4: 最终修正，防止因整数截断导致的 off-by-one 错误
+    // 如果我们得到的 x 的平方大于 n，说明 x 偏大了1，需要减一。
+    if (x * x > n)
+    {
+        x -= 1;
+    }
+    progress.finish();
+    return x;
+}
+
+OMNIINT_INLINE OMNIINT_NOINLINE OmniInt gcd(OmniInt a, OmniInt b)
+{
+    a = a.abs();
+    b = b.abs();
+    OMNIINT_STATS_SCOPE(OmniIntAlgorithm::GcdEuclid, std::max(a.val.size(), b.val.size()));
+    OMNIINT_TRACE_SCOPE(OmniIntTraceOp::Gcd, a.val.size(), b.val.size());
+
+    while (!b.is_zero())
+    {
+        OmniInt r = a % b;
+        a = std::move(b);
+        b = std::move(r);
+    }
+
+    return a;
+}
+
+// --- 整数对数 ---
+namespace omniint_detail
+{
+    // log10(n) 的近似值 (n > 0)：最高 18 位转换为 double，其余数位直接计入指数
+    inline double log10_estimate(const OmniInt &n)
+    {
+        const buffer<int> &d = access::digits(n);
+        const size_t top = std::min<size_t>(d.size(), 18);
+        double lead = 0;
+        for (size_t i = d.size(); i-- > d.size() - top;)
+            lead = lead * 10 + d[i];
+        return std::log10(lead) + static_cast<double>(d.size() - top);
+    }
+
+    /**
+     * @brief log10_estimate() 的绝对误差上界
+     *
+     * 累加前 18 位与求 log10 的舍入不超过 13 个机器精度，加上指数部分的舍入 (L / 2 个机器精度)，
+     * 取 16 * eps * (L + 1)；截去 18 位以下的数位使 n 至多偏小 1e-17 倍，log10 偏小不到 5e-18。
+     */
+    inline double log10_error(double estimate)
+    {
+        return 16 * std::numeric_limits<double>::epsilon() * (estimate + 1) + 5e-18;
+    }
+
+    /**
+     * @brief 用 log10 的近似值估计 log_base(n)，n >= base >= 2
+     *
+     * 估计值 L = log10(n) / log10(base) 的误差不超过 (e(n) + L * e(base)) / log10(base) 再加上除法的舍入，
+     * 其中 e 是 log10_error()。L 与最近整数 k 的距离超过该上界时 floor(L) 就是精确结果，
+     * 否则真值在 k 的哪一侧需要比较 base^k 与 n。对百万位的 n 与 base = 2，上界约为 1e-7。
+     */
+    struct log_estimate
+    {
+        double value;
+        size_t nearest;
+        bool near;
+
+        log_estimate(const OmniInt &n, const OmniInt &base)
+        {
+            const double log_n = log10_estimate(n), log_base = log10_estimate(base);
+            value = log_n / log_base;
+            const double error = (log10_error(log_n) + value * log10_error(log_base)) / log_base +
+                                 std::numeric_limits<double>::epsilon() * value;
+            const double k = std::floor(value + 0.5);
+            nearest = static_cast<size_t>(k);
+            near = std::fabs(value - k) <= error;
+        }
+    };
+
+    /**
+     * @brief base^e，按线程缓存 base^(2^k)
+     *
+     * 分桶、估算大小等场景会对同一个底数反复求对数，平方序列只需计算一次。
+     * 只缓存不超过 cached_power_digits 位的平方，避免长期占用大块内存。
+     */
+    const size_t cached_power_digits = 1 << 16;
+
+    OMNIINT_INLINE OmniInt cached_power(const OmniInt &base, size_t e)
+    {
+        static thread_local OmniInt cached_base;
+        static thread_local std::vector<OmniInt> cached_squares; // cached_squares[k] = base^(2^k)
+        if (cached_squares.empty() || cached_base != base)
+        {
+            cached_base = base;
+            cached_squares.assign(1, base);
+        }
+
+        OmniInt result = 1, computed;
+        const OmniInt *square = nullptr;
+        for (size_t k = 0; (e >> k) != 0; ++k)
+        {
+            if (k < cached_squares.size())
+                square = &cached_squares[k];
+            else
+            {
+                computed = *square * *square;
+                square = &computed;
+                if (k == cached_squares.size() && computed.digitCount() <= cached_power_digits)
+                {
+                    cached_squares.push_back(computed);
+                    square = &cached_squares.back();
+                }
+            }
+            if ((e >> k) & 1)
+                result *= *square;
+        }
+        return result;
+    }
+
+    // n mod m，m < 2^32
+    inline std::uint64_t small_mod(const OmniInt &n, std::uint64_t m)
+    {
+        const buffer<int> &d = access::digits(n);
+        std::uint64_t r = 0;
+        for (size_t i = d.size(); i-- > 0;)
+            r = (r * 10 + static_cast<std::uint64_t>(d[i])) % m;
+        return r;
+    }
+} // namespace omniint_detail
+
+OMNIINT_INLINE size_t ilog(const OmniInt &n, const OmniInt &base)
+{
+    if (n < 1)
+    {
+        throw std::domain_error("Cannot compute logarithm of a non-positive number.");
+    }
+    if (base < 2)
+    {
+        throw std::invalid_argument("Logarithm base must be at least 2");
+    }
+    if (n < base)
+    {
+        return 0;
+    }
+    if (base == 10)
+    {
+        return n.digitCount() - 1;
+    }
+    const omniint_detail::log_estimate estimate(n, base);
+    if (!estimate.near)
+    {
+        return static_cast<size_t>(std::floor(estimate.value));
+    }
+    // 至多一次修正
+    const size_t k = estimate.nearest;
+    return omniint_detail::cached_power(base, k) <= n ? k : k - 1;
+}
+
+OMNIINT_INLINE size_t ilog2(const OmniInt &n)
+{
+    static const OmniInt two(2);
+    return ilog(n, two);
+}
+
+OMNIINT_INLINE size_t ilog10(const OmniInt &n)
+{
+    if (n < 1)
+    {
+        throw std::domain_error("Cannot compute logarithm of a non-positive number.");
+    }
+    return n.digitCount() - 1;
+}
+
+OMNIINT_INLINE bool is_power_of(const OmniInt &n, const OmniInt &base)
+{
+    if (base < 2)
+    {
+        throw std::invalid_argument("Logarithm base must be at least 2");
+    }
+    if (n < 1)
+    {
+        return false;
+    }
+    if (n == 1)
+    {
+        return true;
+    }
+    if (n < base)
+    {
+        return false;
+    }
+    // log_base(n) 离整数较远时 n 不可能是 base 的幂
+    const omniint_detail::log_estimate estimate(n, base);
+    if (!estimate.near)
+    {
+        return false;
+    }
+    // 先比较模一个素数的余数，几乎所有的非幂都在这里被排除，无需计算 base^k
+    const std::uint64_t m = 4294967291ULL;
+    std::uint64_t b = omniint_detail::small_mod(base, m), r = 1;
+    for (size_t e = estimate.nearest; e != 0; e >>= 1, b = b * b % m)
+    {
+        if (e & 1)
+            r = r * b % m;
+    }
+    if (r != omniint_detail::small_mod(n, m))
+    {
+        return false;
+    }
+    return omniint_detail::cached_power(base, estimate.nearest) == n;
+}
+
+// --- 浮点转换 ---
+namespace omniint_detail
+{
+    /**
+     * @brief |n| = (top + tail) * 2^shift，其中 2^63 <= top < 2^64，0 <= tail < 1
+     *
+     * tail 只保留舍入需要的信息 (粘滞位)：0 为零，1 小于 1/2，2 等于 1/2，3 大于 1/2。
+     */
+    struct binary_head
+    {
+        std::uint64_t top;
+        long long shift;
+        int tail;
+    };
+
+    // 十进制小数 0.d[count-1]...d[0] 与 1/2 比较，返回值的含义同 binary_head::tail
+    inline int tail_class(const int *d, size_t count)
+    {
+        if (count == 0)
+            return 0;
+        bool rest = false;
+        for (size_t i = count - 1; i-- > 0 && !rest;)
+            rest = d[i] != 0;
+        const int lead = d[count - 1];
+        if (lead == 5)
+            return rest ? 3 : 2;
+        if (lead > 5)
+            return 3;
+        return lead == 0 && !rest ? 0 : 1;
+    }
+
+    // 把 m * 10^e (m > 0) 拆成整数部分与小数部分；整数部分不在 [2^63, 2^64) 内时返回 false
+    inline bool split_decimal(const OmniInt &m, long long e, binary_head &h)
+    {
+        const buffer<int> &d = access::digits(m);
+        const size_t fraction = e < 0 ? static_cast<size_t>(-e) : 0;
+        if (fraction >= d.size() || d.size() - fraction + static_cast<size_t>(e > 0 ? e : 0) > 20)
+            return false;
+        std::uint64_t top = 0;
+        for (size_t i = d.size(); i-- > fraction;)
+        {
+            if (top > (~0ULL - static_cast<std::uint64_t>(d[i])) / 10)
+                return false;
+            top = top * 10 + static_cast<std::uint64_t>(d[i]);
+        }
+        for (long long i = 0; i < e; ++i)
+        {
+            if (top > ~0ULL / 10)
+                return false;
+            top *= 10;
+        }
+        if (top < (1ULL << 63))
+            return false;
+        h.top = top;
+        h.tail = tail_class(d.data(), fraction);
+        return true;
+    }
+
+    // |a| / 2^shift = |a| * 5^shift / 10^shift：一次乘法加十进制移位，结果精确
+    inline binary_head exact_head(const OmniInt &a, long long shift)
+    {
+        OmniInt product = a.abs() * cached_power(OmniInt(5), static_cast<size_t>(shift));
+        binary_head h;
+        h.shift = shift;
+        split_decimal(product, -shift, h);
+        return h;
+    }
+
+    // 只保留 x 的最高 width 位 (向下取整，x * 10^t 不变)，有截断时返回 true
+    inline bool truncate_digits(OmniInt &x, long long &t, size_t width)
+    {
+        buffer<int> &d = access::digits(x);
+        if (d.size() <= width)
+            return false;
+        const size_t drop = d.size() - width;
+        d.erase(d.begin(), d.begin() + drop);
+        t += static_cast<long long>(drop);
+        return true;
+    }
+
+    /**
+     * @brief 5^e 的上下界 lo * 10^t <= 5^e <= hi * 10^t，lo 与 hi 至多 30 位
+     *
+     * 5^(2^i) 的截断值与 e 无关，按线程缓存，每次只需 popcount(e) 次乘法。
+     * 每次截断的相对误差小于 10^-29，k 次截断后 lo 偏小不超过 lo * 2k * 10^-29 < 20k，
+     * 因此上界取 lo + 20k 即可。
+     */
+    inline void power_of_five_bounds(size_t e, OmniInt &lo, OmniInt &hi, long long &t)
+    {
+        struct square
+        {
+            OmniInt value;
+            long long t;
+            long long truncations;
+        };
+        const size_t width = 30;
+        static thread_local std::vector<square> squares;
+        if (squares.empty())
+        {
+            square first = {OmniInt(5), 0, 0};
+            squares.push_back(first);
+        }
+
+        long long truncations = 0;
+        lo = 1;
+        t = 0;
+        for (size_t i = 0; e != 0; e >>= 1, ++i)
+        {
+            if (i == squares.size())
+            {
+                square next = squares.back();
+                next.value *= next.value;
+                next.t *= 2;
+                next.truncations = next.truncations * 2 + (truncate_digits(next.value, next.t, width) ? 1 : 0);
+                squares.push_back(next);
+            }
+            if (e & 1)
+            {
+                lo *= squares[i].value;
+                t += squares[i].t;
+                truncations += squares[i].truncations + (truncate_digits(lo, t, width) ? 1 : 0);
+            }
+        }
+        hi = lo + 20 * truncations;
+    }
+
+    /**
+     * @brief 只用 |a| 的最高 30 位与 5^shift 的 30 位近似，求 |a| / 2^shift 的下界与上界
+     *
+     * 两个界的相对误差约为 1e-26，远小于舍入所需的 2^-64，代价与 a 的长度无关。
+     */
+    inline bool bounded_head(const OmniInt &a, long long shift, binary_head &lo, binary_head &hi)
+    {
+        const buffer<int> &d = access::digits(a);
+        const size_t keep = 30, s = d.size() - keep;
+        OmniInt top_lo;
+        access::digits(top_lo).assign(d.begin() + s, d.end());
+        OmniInt top_hi = top_lo + 1;
+        OmniInt five_lo, five_hi;
+        long long t;
+        power_of_five_bounds(static_cast<size_t>(shift), five_lo, five_hi, t);
+        lo.shift = hi.shift = shift;
+        const long long base = static_cast<long long>(s) - shift + t;
+        return split_decimal(top_lo * five_lo, base, lo) && split_decimal(top_hi * five_hi, base, hi);
+    }
+
+    // 就近舍入 (平局取偶) 到 p 位有效数字：mantissa * 2^exponent，mantissa <= 2^p
+    inline void round_head(const binary_head &h, int p, std::uint64_t &mantissa, long long &exponent)
+    {
+        bool up;
+        if (p >= 64)
+        {
+            mantissa = h.top;
+            exponent = h.shift;
+            up = h.tail == 3 || (h.tail == 2 && (mantissa & 1));
+        }
+        else
+        {
+            const int drop = 64 - p;
+            const std::uint64_t rest = h.top & ((1ULL << drop) - 1), half = 1ULL << (drop - 1);
+            mantissa = h.top >> drop;
+            exponent = h.shift + drop;
+            up = rest > half || (rest == half && (h.tail != 0 || (mantissa & 1)));
+        }
+        if (up && ++mantissa == 0)
+        {
+            mantissa = 1ULL << 63;
+            ++exponent;
+        }
+    }
+
+    // floor(log2(|n|)) + 1，n != 0
+    inline long long bit_length(const OmniInt &n)
+    {
+        static const OmniInt two(2);
+        const log_estimate estimate(n, two);
+        if (!estimate.near)
+            return static_cast<long long>(std::floor(estimate.value)) + 1;
+        const size_t k = estimate.nearest;
+        const bool at_least = cached_power(two, k) <= n.abs();
+        return static_cast<long long>(at_least ? k : k - 1) + 1;
+    }
+
+    /**
+     * @brief |n| 就近舍入到 p 位有效数字 (p <= 64)：mantissa * 2^exponent，n 为零时 mantissa 为 0
+     *
+     * 先由最高 64 位 top 与粘滞位 tail 构成 binary_head，再舍入一次，因此没有二次舍入误差。
+     * 较长的数先用 bounded_head 的上下界舍入，两者一致时即为结果 (几乎总是如此)；
+     * 只有恰好落在两个浮点数正中间附近时才做一次精确乘法。
+     */
+    inline void round_to_bits(const OmniInt &n, int p, std::uint64_t &mantissa, long long &exponent)
+    {
+        const buffer<int> &d = access::digits(n);
+        binary_head h;
+        if (d.size() <= 20)
+        {
+            std::uint64_t v = 0;
+            bool fits = true;
+            for (size_t i = d.size(); i-- > 0 && fits;)
+            {
+                fits = v <= (~0ULL - static_cast<std::uint64_t>(d[i])) / 10;
+                v = v * 10 + static_cast<std::uint64_t>(d[i]);
+            }
+            if (fits)
+            {
+                if (v == 0)
+                {
+                    mantissa = 0;
+                    exponent = 0;
+                    return;
+                }
+                int shift = 0;
+                for (; (v << shift) < (1ULL << 63); ++shift)
+                {
+                }
+                h.top = v << shift;
+                h.shift = -shift;
+                h.tail = 0;
+                round_head(h, p, mantissa, exponent);
+                return;
+            }
+        }
+
+        const long long shift = bit_length(n) - 64;
+        if (d.size() > 100)
+        {
+            binary_head lo, hi;
+            if (bounded_head(n, shift, lo, hi))
+            {
+                std::uint64_t m_hi;
+                long long e_hi;
+                round_head(lo, p, mantissa, exponent);
+                round_head(hi, p, m_hi, e_hi);
+                if (mantissa == m_hi && exponent == e_hi)
+                    return;
+            }
+        }
+        round_head(exact_head(n, shift), p, mantissa, exponent);
+    }
+
+    template <class F>
+    F to_floating(const OmniInt &n)
+    {
+        const bool negative = access::is_negative(n);
+        // 10^digits 超过浮点最大值时直接溢出
+        const size_t max_digits = static_cast<size_t>(std::numeric_limits<F>::max_exponent * 0.30103) + 2;
+        if (access::digits(n).size() > max_digits)
+            return negative ? -std::numeric_limits<F>::infinity() : std::numeric_limits<F>::infinity();
+        std::uint64_t mantissa;
+        long long exponent;
+        round_to_bits(n, std::numeric_limits<F>::digits, mantissa, exponent);
+        const F result = std::ldexp(static_cast<F>(mantissa), static_cast<int>(exponent));
+        return negative ? -result : result;
+    }
+
+    template <class F>
+    OmniInt from_floating(F x)
+    {
+        if (std::isnan(x) || std::isinf(x))
+        {
+            throw std::domain_error("Cannot convert NaN or infinity to OmniInt");
+        }
+        x = std::trunc(x);
+        if (std::fabs(x) < static_cast<F>(4611686018427387904.0)) // 2^62
+        {
+            return OmniInt(static_cast<long long>(x));
+        }
+        // |x| = m * 2^e，m * 2^p 是不超过 2^64 的整数
+        int e;
+        const int p = std::numeric_limits<F>::digits;
+        std::uint64_t mantissa = static_cast<std::uint64_t>(std::ldexp(std::frexp(std::fabs(x), &e), p));
+        if (e < p)
+        {
+            mantissa >>= p - e;
+        }
+        OmniInt result = OmniInt(static_cast<long long>(mantissa >> 1)) * 2 + static_cast<long long>(mantissa & 1);
+        if (e > p)
+        {
+            result *= cached_power(OmniInt(2), static_cast<size_t>(e - p));
+        }
+        return x < 0 ? -result : result;
+    }
+} // namespace omniint_detail
+
+OMNIINT_INLINE double OmniInt::to_double() const
+{
+    return omniint_detail::to_floating<double>(*this);
+}
+
+OMNIINT_INLINE long double OmniInt::to_long_double() const
+{
+    return omniint_detail::to_floating<long double>(*this);
+}
+
+OMNIINT_INLINE double OmniInt::to_double_2exp(long long &exponent) const
+{
+    const int p = std::numeric_limits<double>::digits;
+    std::uint64_t mantissa;
+    omniint_detail::round_to_bits(*this, p, mantissa, exponent);
+    if (mantissa == 0)
+    {
+        exponent = 0;
+        return 0.0;
+    }
+    // mantissa 在 [2^(p-1), 2^p] 内，舍入进位时可能恰好等于 2^p
+    double d = std::ldexp(static_cast<double>(mantissa), -p);
+    exponent += p;
+    if (d == 1.0)
+    {
+        d = 0.5;
+        ++exponent;
+    }
+    return pos ? d : -d;
+}
+
+OMNIINT_INLINE OmniInt OmniInt::from_double(double x)
+{
+    return omniint_detail::from_floating(x);
+}
+
+OMNIINT_INLINE OmniInt OmniInt::from_long_double(long double x)
+{
+    return omniint_detail::from_floating(x);
+}
+
+// --- 截断乘法 ---
+OMNIINT_INLINE OmniInt mul_low(const OmniInt &a, const OmniInt &b, size_t n)
+{
+    if (n == 0 || a.is_zero() || b.is_zero())
+        return 0;
+    using omniint_detail::access;
+    const omniint_detail::buffer<int> &da = access::digits(a), &db = access::digits(b);
+    if (n >= da.size() + db.size())
+        return a * b;
+    if (omniint_detail::uses_transform(da.size(), db.size()))
+    {
+        // FFT / NTT 的完整乘积比截断的 Karatsuba 乘积更快
+        OmniInt product = a * b;
+        access::digits(product).resize(n);
+        access::normalize(product);
+        return product;
+    }
+
+    OmniInt result;
+    {
+        OMNIINT_SCRATCH_SCOPE();
+        omniint_detail::buffer<long long> columns(n, 0);
+        omniint_detail::mul_low_columns(da.data(), da.size(), db.data(), db.size(), n, columns.data());
+        OMNIINT_SCRATCH_END();
+        omniint_detail::carry_columns(columns.data(), n, access::digits(result), false);
+    }
+    access::normalize(result);
+    access::set_negative(result, !result.is_zero() && access::is_negative(a) != access::is_negative(b));
+    return result;
+}
+
+OMNIINT_INLINE OmniInt mul_high(const OmniInt &a, const OmniInt &b, size_t n)
+{
+    if (n == 0 || a.is_zero() || b.is_zero())
+        return 0;
+    using omniint_detail::access;
+    const omniint_detail::buffer<int> &da = access::digits(a), &db = access::digits(b);
+    const size_t la = da.size(), lb = db.size(), total = la + lb;
+    if (n >= total)
+        return a * b;
+    const size_t shift = total - n;
+
+    // 第 c 列不超过 81 * min(la, lb)，因此低于第 t 列的所有列合计不到 bound * 10^t
+    const size_t bound = 9 * std::min(la, lb);
+    size_t guard = 2;
+    for (size_t e = bound; e > 0; e /= 10)
+        ++guard;
+
+    OmniInt result;
+    bool exact = false;
+    if (shift > guard && !omniint_detail::uses_transform(la, lb))
+    {
+        // 把两个乘数倒序后，原乘积的高位列就是新乘积的低位列
+        const size_t t = shift - guard;
+        const size_t count = total - 1 - t;
+        OmniInt high;
+        {
+            OMNIINT_SCRATCH_SCOPE();
+            omniint_detail::buffer<int> ra(da.rbegin(), da.rend()), rb(db.rbegin(), db.rend());
+            omniint_detail::buffer<long long> columns(count, 0);
+            omniint_detail::mul_low_columns(ra.data(), la, rb.data(), lb, count, columns.data());
+            std::reverse(columns.begin(), columns.end());
+            OMNIINT_SCRATCH_END();
+            omniint_detail::carry_columns(columns.data(), count, access::digits(high), true);
+        }
+        access::normalize(high);
+
+        // 真实值介于 high 与 high + bound 之间；两者截去 guard 位后相同时结果是精确的
+        OmniInt upper = high + OmniInt(static_cast<long long>(bound));
+        omniint_detail::drop_low_digits(high, guard);
+        omniint_detail::drop_low_digits(upper, guard);
+        if (high == upper)
+        {
+            result = std::move(high);
+            exact = true;
+        }
+    }
+    if (!exact)
+    {
+        // 低位部分的进位可能影响结果、乘积本身很短或 FFT / NTT 的完整乘积更快：使用完整乘法
+        result = a.abs() * b.abs();
+        omniint_detail::drop_low_digits(result, shift);
+    }
+    access::set_negative(result, !result.is_zero() && access::is_negative(a) != access::is_negative(b));
+    return result;
+}
+
+// --- 预变换乘法 ---
+OMNIINT_INLINE OmniIntPreparedMultiplier::OmniIntPreparedMultiplier(const OmniInt &x) : value_(x) {}
+
+OMNIINT_INLINE void OmniIntPreparedMultiplier::clear_cache()
+{
+    transforms_.clear();
+}
+
+OMNIINT_INLINE const OmniIntPreparedMultiplier::cached_transform &
+OmniIntPreparedMultiplier::transform(size_t length, size_t limb_digits)
+{
+    for (size_t i = 0; i < transforms_.size(); ++i)
+    {
+        if (transforms_[i].length == length && transforms_[i].limb_digits == limb_digits)
+            return transforms_[i];
+    }
+
+    cached_transform entry;
+    entry.length = length;
+    entry.limb_digits = limb_digits;
+    const omniint_detail::buffer<int> &digits = omniint_detail::access::digits(value_);
+    if (limb_digits == 0)
+    {
+        const omniint_detail::ntt::plan p(length);
+        entry.ntt.resize(length);
+        omniint_detail::ntt::pack(digits.data(), digits.size(), entry.ntt.data(), length);
+        p.forward(entry.ntt.data());
+    }
+    else
+    {
+        entry.re.resize(length / 2);
+        entry.im.resize(length / 2);
+        omniint_detail::fft::real_forward(digits.data(), digits.size(), limb_digits, entry.re.data(), entry.im.data(),
+                                          length / 2, omniint_detail::fft::twiddles_for(length));
+    }
+    transforms_.push_back(std::move(entry));
+    return transforms_.back();
+}
+
+OMNIINT_INLINE OmniInt OmniIntPreparedMultiplier::mul(const OmniInt &y)
+{
+    using omniint_detail::access;
+    const omniint_detail::buffer<int> &dx = access::digits(value_), &dy = access::digits(y);
+    if (value_.is_zero() || y.is_zero())
+        return value_ * y;
+
+    // 与 operator* 相同地选择算法，只有 FFT 与 NTT 能使用缓存的变换
+    typedef omniint_detail::mul_kernel mul_kernel;
+    const mul_kernel kernel = omniint_detail::mul_algorithm(dx.size(), dy.size());
+    size_t length = 0, limb_digits = 0;
+    if (kernel == mul_kernel::fft)
+        limb_digits = omniint_detail::fft::choose(dx.size(), dy.size(), length);
+    else if (kernel == mul_kernel::ntt)
+        length = omniint_detail::ntt::length_for(dy.size(), dx.size());
+    if (length == 0)
+        return value_ * y;
+
+    OMNIINT_STATS_SCOPE(limb_digits != 0 ? OmniIntAlgorithm::MulFft : OmniIntAlgorithm::MulNtt,
+                        std::max(dx.size(), dy.size()));
+    OMNIINT_TRACE_SCOPE(OmniIntTraceOp::Multiply, dx.size(), dy.size());
+    omniint_detail::progress_scope progress(true);
+
+    // 缓存的变换随对象一直保留，不计入临时内存
+    const cached_transform &fx = transform(length, limb_digits);
+
+    OmniInt result;
+    {
+        OMNIINT_SCRATCH_SCOPE();
+        omniint_detail::buffer<long long> columns(dx.size() + dy.size(), 0);
+        if (limb_digits != 0)
+        {
+            const size_t m = length / 2;
+            const omniint_detail::fft::twiddles &w = omniint_detail::fft::twiddles_for(length);
+            omniint_detail::buffer<double> re(m), im(m);
+            omniint_detail::fft::real_forward(dy.data(), dy.size(), limb_digits, re.data(), im.data(), m, w);
+            const size_t limbs = omniint_detail::fft::limbs_for(dx.size(), limb_digits) +
+                                 omniint_detail::fft::limbs_for(dy.size(), limb_digits) - 1;
+            omniint_detail::fft::real_multiply_inverse(fx.re.data(), fx.im.data(), re.data(), im.data(), m, w,
+                                                       limbs, limb_digits, columns.data());
+        }
+        else
+        {
+            const omniint_detail::ntt::plan p(length);
+            omniint_detail::ntt::multiply_transformed(dy.data(), dy.size(), fx.ntt.data(),
+                                                      omniint_detail::ntt::limbs_for(dx.size()), p, columns.data());
+        }
+        OMNIINT_SCRATCH_END();
+        omniint_detail::carry_columns(columns.data(), columns.size(), access::digits(result), true);
+    }
+    access::normalize(result);
+    access::set_negative(result, access::is_negative(value_) != access::is_negative(y));
+    progress.finish();
+    return result;
+}
+
+#endif // OmniInt_impl_H
@@ -0,0 +1,569 @@
+/*
+OmniMatrix.h
+
+This is a header file for dense matrices with OmniInt entries and exact
+linear algebra over the integers.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniMatrix_H
+#define OmniMatrix_H
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "OmniInt.h"
+#include "OmniIntSum.h"
+
+// 不使用多模乘法、且两个矩阵的行数、列数与公共维数都不小于该值时，乘法使用 Strassen 分块
+#ifndef OMNIMATRIX_STRASSEN_THRESHOLD
+#define OMNIMATRIX_STRASSEN_THRESHOLD 32
+#endif
+
+namespace omniint_detail
+{
+    /**
+     * @brief 多模矩阵乘法使用的工具：一组略小于 2^31 的素数、十进制数位的取模与中国剩余定理重建
+     */
+    namespace multimodular
+    {
+        inline std::uint32_t power_mod(std::uint64_t base, std::uint64_t exponent, std::uint32_t p)
+        {
+            std::uint64_t result = 1;
+            base %= p;
+            for (; exponent > 0; exponent >>= 1)
+            {
+                if (exponent & 1)
+                    result = result * base % p;
+                base = base * base % p;
+            }
+            return static_cast<std::uint32_t>(result);
+        }
+
+        // 对小于 2^32 的 n，以 2、7、61 为底的 Miller-Rabin 检验是确定性的
+        inline bool is_prime(std::uint32_t n)
+        {
+            if (n < 2 || n % 2 == 0)
+                return n == 2;
+            std::uint32_t d = n - 1;
+            unsigned s = 0;
+            for (; d % 2 == 0; d /= 2)
+                ++s;
+            static const std::uint32_t bases[] = {2, 7, 61};
+            for (std::uint32_t a : bases)
+            {
+                if (a % n == 0)
+                    continue;
+                std::uint64_t x = power_mod(a, d, n);
+                if (x == 1 || x == n - 1)
+                    continue;
+                unsigned r = 1;
+                for (; r < s; ++r)
+                {
+                    x = x * x % n;
+                    if (x == n - 1)
+                        break;
+                }
+                if (r == s)
+                    return false;
+            }
+            return true;
+        }
+
+        // 小于 2^31 的最大的 count 个素数 (每个都大于 2^30)
+        inline std::vector<std::uint32_t> primes(size_t count)
+        {
+            std::vector<std::uint32_t> result;
+            for (std::uint32_t n = 0x7FFFFFFF; result.size() < count; n -= 2)
+            {
+                if (is_prime(n))
+                    result.push_back(n);
+            }
+            return result;
+        }
+
+        // |n| mod p，按每 9 位一组从高位到低位计算；n 为负数时返回 -|n| mod p
+        inline std::uint32_t residue(const OmniInt &n, std::uint32_t p)
+        {
+            const buffer<int> &d = access::digits(n);
+            std::uint64_t r = 0;
+            size_t i = d.size();
+            const size_t head = i % 9 == 0 ? 9 : i % 9;
+            std::uint64_t scale = 1;
+            for (size_t j = 0; j < head; ++j)
+                scale *= 10;
+            for (size_t count = head; i > 0; count = 9, scale = 1000000000)
+            {
+                std::uint64_t chunk = 0;
+                for (size_t j = 0; j < count; ++j)
+                    chunk = chunk * 10 + static_cast<std::uint64_t>(d[--i]);
+                r = (r * scale + chunk) % p;
+            }
+            return access::is_negative(n) && r != 0 ? static_cast<std::uint32_t>(p - r) : static_cast<std::uint32_t>(r);
+        }
+
+        /**
+         * @brief 由各个素数下的余数重建 x (0 <= x < 所有素数之积)
+         *
+         * Garner 算法先求出混合进制的各位 v_j，再以 10^9 为进制按秦九韶算法展开为十进制。
+         * inverses[j][l] 为 p_l 在模 p_j 下的逆元 (l < j)。
+         */
+        inline OmniInt reconstruct(const std::uint32_t *residues, const std::vector<std::uint32_t> &p,
+                                   const std::vector<std::vector<std::uint32_t>> &inverses,
+                                   std::vector<std::uint32_t> &v, std::vector<std::uint32_t> &limbs)
+        {
+            const size_t t = p.size();
+            for (size_t j = 0; j < t; ++j)
+            {
+                std::uint64_t x = residues[j];
+                for (size_t l = 0; l < j; ++l)
+                    x = (x + p[j] - v[l] % p[j]) % p[j] * inverses[j][l] % p[j];
+                v[j] = static_cast<std::uint32_t>(x);
+            }
+
+            limbs.clear();
+            for (size_t j = t; j-- > 0;)
+            {
+                std::uint64_t carry = v[j];
+                for (size_t i = 0; i < limbs.size(); ++i)
+                {
+                    const std::uint64_t value = static_cast<std::uint64_t>(limbs[i]) * p[j] + carry;
+                    limbs[i] = static_cast<std::uint32_t>(value % 1000000000);
+                    carry = value / 1000000000;
+                }
+                for (; carry > 0; carry /= 1000000000)
+                    limbs.push_back(static_cast<std::uint32_t>(carry % 1000000000));
+            }
+
+            OmniInt result;
+            buffer<int> &digits = access::digits(result);
+            digits.assign(9 * limbs.size(), 0);
+            for (size_t i = 0; i < limbs.size(); ++i)
+            {
+                std::uint32_t limb = limbs[i];
+                for (size_t j = 0; j < 9; ++j, limb /= 10)
+                    digits[9 * i + j] = static_cast<int>(limb % 10);
+            }
+            access::normalize(result);
+            return result;
+        }
+    } // namespace multimodular
+} // namespace omniint_detail
+
+/**
+ * @class OmniMatrix
+ * @brief 元素为 OmniInt 的稠密矩阵，按行优先存放。
+ *
+ * 元素的位数相对于矩阵的维数不太大时，乘法在若干个机器字大小的素数下分别计算，再用中国
+ * 剩余定理重建 (多模方法)。否则逐个元素相乘，每个元素用 OmniIntSum 累加，同一个左元素与
+ * 整行右元素相乘时复用它的 FFT / NTT 变换；矩阵足够大时用 Strassen 分块把 8 次子矩阵乘法
+ * 减为 7 次。
+ * 行列式与线性方程组使用无分数的 Bareiss 消元，所有中间结果都是整数，除法都是整除。
+ */
+class OmniMatrix
+{
+public:
+    OmniMatrix() : rows_(0), cols_(0) {}
+    OmniMatrix(size_t rows, size_t cols) : rows_(rows), cols_(cols), data_(rows * cols) {}
+
+    // 按行给出元素，例如 OmniMatrix{{1, 2}, {3, 4}}
+    OmniMatrix(std::initializer_list<std::initializer_list<OmniInt>> rows) : rows_(rows.size()), cols_(0)
+    {
+        if (rows_ > 0)
+            cols_ = rows.begin()->size();
+        data_.reserve(rows_ * cols_);
+        for (const std::initializer_list<OmniInt> &row : rows)
+        {
+            if (row.size() != cols_)
+                throw std::invalid_argument("OmniMatrix rows must have the same length");
+            data_.insert(data_.end(), row.begin(), row.end());
+        }
+    }
+
+    static OmniMatrix identity(size_t n)
+    {
+        OmniMatrix m(n, n);
+        for (size_t i = 0; i < n; ++i)
+            m(i, i) = 1;
+        return m;
+    }
+
+    // =================================================================
+    // Access - 访问
+    // =================================================================
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+
+    OmniInt &operator()(size_t i, size_t j) { return data_[i * cols_ + j]; }
+    const OmniInt &operator()(size_t i, size_t j) const { return data_[i * cols_ + j]; }
+
+    OmniMatrix transpose() const
+    {
+        OmniMatrix t(cols_, rows_);
+        for (size_t i = 0; i < rows_; ++i)
+            for (size_t j = 0; j < cols_; ++j)
+                t(j, i) = (*this)(i, j);
+        return t;
+    }
+
+    // =================================================================
+    // Arithmetic - 算术运算
+    // =================================================================
+    OmniMatrix &operator+=(const OmniMatrix &other)
+    {
+        require_same_shape(other);
+        for (size_t i = 0; i < data_.size(); ++i)
+            data_[i] += other.data_[i];
+        return *this;
+    }
+
+    OmniMatrix &operator-=(const OmniMatrix &other)
+    {
+        require_same_shape(other);
+        for (size_t i = 0; i < data_.size(); ++i)
+            data_[i] -= other.data_[i];
+        return *this;
+    }
+
+    OmniMatrix &operator*=(const OmniInt &c)
+    {
+        for (size_t i = 0; i < data_.size(); ++i)
+            data_[i] *= c;
+        return *this;
+    }
+
+    OmniMatrix &operator*=(const OmniMatrix &other) { return *this = *this * other; }
+
+    friend OmniMatrix operator+(OmniMatrix a, const OmniMatrix &b) { return a += b; }
+    friend OmniMatrix operator-(OmniMatrix a, const OmniMatrix &b) { return a -= b; }
+    friend OmniMatrix operator*(OmniMatrix a, const OmniInt &c) { return a *= c; }
+    friend OmniMatrix operator*(const OmniInt &c, OmniMatrix a) { return a *= c; }
+
+    /**
+     * @brief 矩阵乘法
+     * @throw std::invalid_argument a 的列数与 b 的行数不同
+     */
+    friend OmniMatrix operator*(const OmniMatrix &a, const OmniMatrix &b)
+    {
+        if (a.cols_ != b.rows_)
+            throw std::invalid_argument("OmniMatrix dimensions do not match for multiplication");
+        if (a.rows_ == 0 || a.cols_ == 0 || b.cols_ == 0)
+            return OmniMatrix(a.rows_, b.cols_);
+        // 多模乘法的代价约为每个元素 inner * count + count^2 次机器字运算，
+        // 素数个数 count 不超过公共维数的 8 倍时明显快于逐个元素相乘
+        if (prime_count(product_exponent(a, b)) <= 8 * a.cols_)
+            return multimodular(a, b);
+        if (std::min(std::min(a.rows_, a.cols_), b.cols_) >= OMNIMATRIX_STRASSEN_THRESHOLD)
+            return strassen(a, b);
+        return classical(a, b);
+    }
+
+    friend bool operator==(const OmniMatrix &a, const OmniMatrix &b)
+    {
+        return a.rows_ == b.rows_ && a.cols_ == b.cols_ && a.data_ == b.data_;
+    }
+    friend bool operator!=(const OmniMatrix &a, const OmniMatrix &b) { return !(a == b); }
+
+    // =================================================================
+    // Exact Linear Algebra - 精确线性代数
+    // =================================================================
+
+    /**
+     * @brief 行列式 (Bareiss 消元)
+     *
+     * 第 k 步消元后，每个元素都是原矩阵某个 (k+1) 阶子式，因此除以上一步的主元总是整除，
+     * 中间结果的位数不会超过行列式本身的量级。
+     *
+     * @throw std::invalid_argument 矩阵不是方阵
+     */
+    OmniInt determinant() const
+    {
+        if (rows_ != cols_)
+            throw std::invalid_argument("OmniMatrix determinant requires a square matrix");
+        if (rows_ == 0)
+            return 1;
+        OmniMatrix m(*this);
+        bool negate = false;
+        if (!m.eliminate(rows_, negate))
+            return 0;
+        const OmniInt &det = m(rows_ - 1, rows_ - 1);
+        return negate ? -det : det;
+    }
+
+    /**
+     * @brief 求解 a * x = b (b 可以有多列)，返回整数矩阵 x_num 与分母 d > 0，使 a * x_num = d * b
+     *
+     * 先对增广矩阵 [a | b] 做 Bareiss 消元，此时最后一个主元是 ±det(a)；再按 Cramer 法则做
+     * 无分数的回代，det(a) * x 的每个元素都是整数，回代中的除法都是整除。
+     * d 为 |det(a)|，结果未约分。
+     *
+     * @throw std::invalid_argument 维数不匹配
+     * @throw std::domain_error a 是奇异矩阵
+     */
+    friend OmniMatrix solve(const OmniMatrix &a, const OmniMatrix &b, OmniInt &denominator)
+    {
+        if (a.rows_ != a.cols_ || b.rows_ != a.rows_)
+            throw std::invalid_argument("OmniMatrix dimensions do not match for solve");
+        const size_t n = a.rows_, m = b.cols_;
+        OmniMatrix augmented(n, n + m);
+        for (size_t i = 0; i < n; ++i)
+        {
+            std::copy(a.data_.begin() + i * n, a.data_.begin() + (i + 1) * n, augmented.data_.begin() + i * (n + m));
+            std::copy(b.data_.begin() + i * m, b.data_.begin() + (i + 1) * m,
+                      augmented.data_.begin() + i * (n + m) + n);
+        }
+        bool negate = false;
+        if (n > 0 && !augmented.eliminate(n, negate))
+            throw std::domain_error("OmniMatrix is singular");
+        // 消元后的上三角部分满足 U x = c，其中 U(n-1, n-1) = ±det(a)
+        const OmniInt det = n == 0 ? OmniInt(1) : augmented(n - 1, n - 1);
+
+        OmniMatrix x(n, m);
+        for (size_t c = 0; c < m; ++c)
+        {
+            for (size_t i = n; i-- > 0;)
+            {
+                OmniIntSum sum(det * augmented(i, n + c));
+                for (size_t j = i + 1; j < n; ++j)
+                    sum -= augmented(i, j) * x(j, c);
+                x(i, c) = sum.value() / augmented(i, i);
+            }
+        }
+        denominator = det.abs();
+        if (det < 0)
+            x *= OmniInt(-1);
+        return x;
+    }
+
+    // =================================================================
+    // Output - 输出
+    // =================================================================
+    // 每行一个方括号，例如 "[[1, 2], [3, 4]]"
+    std::string toString() const
+    {
+        std::string s = "[";
+        for (size_t i = 0; i < rows_; ++i)
+        {
+            s += i == 0 ? "[" : ", [";
+            for (size_t j = 0; j < cols_; ++j)
+                s += (j == 0 ? "" : ", ") + (*this)(i, j).toString();
+            s += "]";
+        }
+        return s + "]";
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const OmniMatrix &m) { return os << m.toString(); }
+
+private:
+    void require_same_shape(const OmniMatrix &other) const
+    {
+        if (rows_ != other.rows_ || cols_ != other.cols_)
+            throw std::invalid_argument("OmniMatrix dimensions do not match");
+    }
+
+    size_t max_digits() const
+    {
+        size_t digits = 1;
+        for (size_t i = 0; i < data_.size(); ++i)
+            digits = std::max(digits, data_[i].digitCount());
+        return digits;
+    }
+
+    // a * b 的每个元素的绝对值小于 inner * 10^(da + db) <= 10^e，返回 e
+    static size_t product_exponent(const OmniMatrix &a, const OmniMatrix &b)
+    {
+        size_t e = a.max_digits() + b.max_digits();
+        for (size_t n = a.cols_; n > 0; n /= 10)
+            ++e;
+        return e;
+    }
+
+    /**
+     * @brief 多模乘法：在若干个约 2^31 的素数下分别做机器字的矩阵乘法，再用中国剩余定理重建
+     *
+     * 设 |c(i, j)| < 10^e (见 product_exponent)。各素数下先算 c + 10^e，素数之积大于 2 * 10^e，
+     * 重建出的就是非负的 c + 10^e，最后减去 10^e。
+     */
+    static OmniMatrix multimodular(const OmniMatrix &a, const OmniMatrix &b)
+    {
+        namespace mm = omniint_detail::multimodular;
+        const size_t rows = a.rows_, inner = a.cols_, cols = b.cols_;
+        const size_t e = product_exponent(a, b);
+        const std::vector<std::uint32_t> p = mm::primes(prime_count(e));
+        const size_t count = p.size();
+
+        OmniInt offset; // 10^e
+        omniint_detail::access::digits(offset).assign(e + 1, 0);
+        omniint_detail::access::digits(offset)[e] = 1;
+
+        std::vector<std::uint32_t> ar(rows * inner), br(inner * cols), cr(rows * cols * count);
+        std::vector<std::uint64_t> sum(cols);
+        for (size_t q = 0; q < count; ++q)
+        {
+            const std::uint32_t prime = p[q];
+            for (size_t i = 0; i < ar.size(); ++i)
+                ar[i] = mm::residue(a.data_[i], prime);
+            for (size_t i = 0; i < br.size(); ++i)
+                br[i] = mm::residue(b.data_[i], prime);
+            const std::uint64_t shift = mm::residue(offset, prime);
+            for (size_t i = 0; i < rows; ++i)
+            {
+                std::fill(sum.begin(), sum.end(), 0);
+                for (size_t k = 0; k < inner; ++k)
+                {
+                    const std::uint64_t x = ar[i * inner + k];
+                    const std::uint32_t *row = &br[k * cols];
+                    for (size_t j = 0; j < cols; ++j)
+                        sum[j] += x * row[j];
+                    // 每个乘积小于 2^62，累加 3 次后约减一次，不会溢出
+                    if (k % 3 == 2)
+                    {
+                        for (size_t j = 0; j < cols; ++j)
+                            sum[j] %= prime;
+                    }
+                }
+                for (size_t j = 0; j < cols; ++j)
+                    cr[(i * cols + j) * count + q] = static_cast<std::uint32_t>((sum[j] % prime + shift) % prime);
+            }
+        }
+
+        std::vector<std::vector<std::uint32_t>> inverses(count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            inverses[j].resize(j);
+            for (size_t l = 0; l < j; ++l)
+                inverses[j][l] = mm::power_mod(p[l], p[j] - 2, p[j]);
+        }
+        OmniMatrix c(rows, cols);
+        std::vector<std::uint32_t> v(count), limbs;
+        for (size_t i = 0; i < c.data_.size(); ++i)
+            c.data_[i] = mm::reconstruct(&cr[i * count], p, inverses, v, limbs) - offset;
+        return c;
+    }
+
+    // 素数之积超过 2 * 10^e 所需的素数个数 (每个素数大于 2^30)
+    static size_t prime_count(size_t e) { return static_cast<size_t>(e * 3.3219280948873623 + 1) / 30 + 1; }
+
+    // 朴素乘法：c(i, j) 的各项用 OmniIntSum 累加；a(i, k) 与第 k 行的所有元素相乘时复用变换
+    static OmniMatrix classical(const OmniMatrix &a, const OmniMatrix &b)
+    {
+        OmniMatrix c(a.rows_, b.cols_);
+        std::vector<OmniIntSum> row(b.cols_);
+        for (size_t i = 0; i < a.rows_; ++i)
+        {
+            for (size_t k = 0; k < a.cols_; ++k)
+            {
+                const OmniInt &x = a(i, k);
+                if (x.is_zero())
+                    continue;
+                OmniIntPreparedMultiplier prepared(x);
+                for (size_t j = 0; j < b.cols_; ++j)
+                {
+                    if (!b(k, j).is_zero())
+                        row[j] += prepared.mul(b(k, j));
+                }
+            }
+            for (size_t j = 0; j < b.cols_; ++j)
+            {
+                c(i, j) = row[j].value();
+                row[j].clear();
+            }
+        }
+        return c;
+    }
+
+    // 取出从 (row, col) 开始的 rows x cols 子矩阵，超出范围的部分补零
+    OmniMatrix block(size_t row, size_t col, size_t rows, size_t cols) const
+    {
+        OmniMatrix m(rows, cols);
+        for (size_t i = 0; i < rows && row + i < rows_; ++i)
+            for (size_t j = 0; j < cols && col + j < cols_; ++j)
+                m(i, j) = (*this)(row + i, col + j);
+        return m;
+    }
+
+    // 把 m 写回从 (row, col) 开始的位置，超出范围的部分丢弃
+    void place(const OmniMatrix &m, size_t row, size_t col)
+    {
+        for (size_t i = 0; i < m.rows_ && row + i < rows_; ++i)
+            for (size_t j = 0; j < m.cols_ && col + j < cols_; ++j)
+                (*this)(row + i, col + j) = m(i, j);
+    }
+
+    /**
+     * @brief Strassen 乘法：把 a、b 各分成 2 x 2 块 (奇数维补零)，用 7 次子矩阵乘法代替 8 次
+     *
+     * 元素是大整数时乘法远比加法昂贵，节省的乘法抵得过多出来的 18 次子矩阵加减。
+     * 子矩阵乘法递归地调用 operator*，规模低于阈值时回到朴素乘法。
+     */
+    static OmniMatrix strassen(const OmniMatrix &a, const OmniMatrix &b)
+    {
+        const size_t n = (a.rows_ + 1) / 2, k = (a.cols_ + 1) / 2, m = (b.cols_ + 1) / 2;
+        const OmniMatrix a11 = a.block(0, 0, n, k), a12 = a.block(0, k, n, k);
+        const OmniMatrix a21 = a.block(n, 0, n, k), a22 = a.block(n, k, n, k);
+        const OmniMatrix b11 = b.block(0, 0, k, m), b12 = b.block(0, m, k, m);
+        const OmniMatrix b21 = b.block(k, 0, k, m), b22 = b.block(k, m, k, m);
+
+        const OmniMatrix m1 = (a11 + a22) * (b11 + b22);
+        const OmniMatrix m2 = (a21 + a22) * b11;
+        const OmniMatrix m3 = a11 * (b12 - b22);
+        const OmniMatrix m4 = a22 * (b21 - b11);
+        const OmniMatrix m5 = (a11 + a12) * b22;
+        const OmniMatrix m6 = (a21 - a11) * (b11 + b12);
+        const OmniMatrix m7 = (a12 - a22) * (b21 + b22);
+
+        OmniMatrix c(a.rows_, b.cols_);
+        c.place(m1 + m4 - m5 + m7, 0, 0);
+        c.place(m3 + m5, 0, m);
+        c.place(m2 + m4, n, 0);
+        c.place(m1 - m2 + m3 + m6, n, m);
+        return c;
+    }
+
+    /**
+     * @brief 对前 n 列做 Bareiss 消元，得到上三角形式 (其余列随之变换)
+     * @return 某一列找不到非零主元时返回 false (前 n 列奇异)
+     *
+     * 需要交换行时翻转 negate。消元后 (n-1, n-1) 处是 ±det。
+     */
+    bool eliminate(size_t n, bool &negate)
+    {
+        OmniInt previous = 1;
+        for (size_t k = 0; k < n; ++k)
+        {
+            size_t pivot = k;
+            while (pivot < rows_ && (*this)(pivot, k).is_zero())
+                ++pivot;
+            if (pivot == rows_)
+                return false;
+            if (pivot != k)
+            {
+                for (size_t j = 0; j < cols_; ++j)
+                    std::swap((*this)(pivot, j), (*this)(k, j));
+                negate = !negate;
+            }
+            const OmniInt &p = (*this)(k, k);
+            for (size_t i = k + 1; i < rows_; ++i)
+            {
+                const OmniInt f = (*this)(i, k);
+                for (size_t j = k + 1; j < cols_; ++j)
+                    (*this)(i, j) = (p * (*this)(i, j) - f * (*this)(k, j)) / previous;
+                (*this)(i, k) = 0;
+            }
+            previous = p;
+        }
+        return true;
+    }
+
+    size_t rows_, cols_;
+    std::vector<OmniInt> data_;
+};
+
+#endif // OmniMatrix_H
@@ -0,0 +1,342 @@
+/*
+OmniPoly.h
+
+This is a header file for polynomials with OmniInt coefficients.
+
+Copyright(c) 2025 SharkyMew
+*/
+
+#ifndef OmniPoly_H
+#define OmniPoly_H
+
+#include <algorithm>
+#include <initializer_list>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "OmniInt.h"
+
+namespace omniint_detail
+{
+    inline size_t digit_count(size_t n)
+    {
+        size_t count = 1;
+        for (; n >= 10; n /= 10)
+            ++count;
+        return count;
+    }
+
+    /**
+     * @brief Kronecker 代换：计算 sum(coefficients[i] * 10^(width * i))
+     *
+     * 正系数与负系数的绝对值分别按位写入两个数位数组，最后只做一次减法。
+     */
+    inline OmniInt kronecker_pack(const std::vector<OmniInt> &coefficients, size_t width)
+    {
+        OmniInt positive, negative;
+        buffer<int> &p = access::digits(positive);
+        buffer<int> &n = access::digits(negative);
+        p.assign(width * coefficients.size(), 0);
+        n.assign(width * coefficients.size(), 0);
+        for (size_t i = 0; i < coefficients.size(); ++i)
+        {
+            const buffer<int> &d = access::digits(coefficients[i]);
+            buffer<int> &target = access::is_negative(coefficients[i]) ? n : p;
+            std::copy(d.begin(), d.end(), target.begin() + width * i);
+        }
+        access::normalize(positive);
+        access::normalize(negative);
+        return positive - negative;
+    }
+
+    /**
+     * @brief Kronecker 代换的逆：把 value 拆成 count 个以 10^width 为进制的平衡数位
+     *
+     * 要求每个系数的绝对值小于 10^width / 2。每一块按无符号读出后，若不小于 10^width / 2
+     * 就减去 10^width，并向高一块借 1。
+     */
+    inline std::vector<OmniInt> kronecker_unpack(const OmniInt &value, size_t width, size_t count)
+    {
+        std::vector<OmniInt> coefficients(count);
+        const buffer<int> &d = access::digits(value);
+        const bool negative = access::is_negative(value);
+        OmniInt radix; // 10^width
+        access::digits(radix).assign(width + 1, 0);
+        access::digits(radix)[width] = 1;
+        bool carry = false;
+        for (size_t i = 0; i < count; ++i)
+        {
+            OmniInt &c = coefficients[i];
+            buffer<int> &digits = access::digits(c);
+            const size_t begin = std::min(d.size(), width * i), end = std::min(d.size(), width * (i + 1));
+            digits.assign(d.begin() + begin, d.begin() + end);
+            access::normalize(c);
+            if (carry)
+                ++c;
+            carry = c + c >= radix;
+            if (carry)
+                c -= radix;
+            if (negative)
+                c = -c;
+        }
+        return coefficients;
+    }
+} // namespace omniint_detail
+
+/**
+ * @class OmniPoly
+ * @brief 以 OmniInt 为系数的一元多项式，系数按次数从低到高存放。
+ *
+ * 乘法使用 Kronecker 代换：把两个多项式分别在 x = 10^w 处求值为一个大整数，
+ * 相乘一次后再拆回系数 (w 足够大，保证乘积的各个系数互不重叠)。
+ * 这样只调用一次 OmniInt 的乘法，可以直接用上 FFT / NTT 等快速算法，
+ * 而逐项相乘需要调用 O(n^2) 次 operator*。
+ *
+ * 系数表总是去掉最高次的零系数，零多项式没有系数，次数为 -1。
+ */
+class OmniPoly
+{
+public:
+    OmniPoly() {}
+    OmniPoly(const OmniInt &constant) : coefficients_(1, constant) { trim(); }
+    OmniPoly(long long constant) : coefficients_(1, OmniInt(constant)) { trim(); }
+    OmniPoly(std::initializer_list<OmniInt> coefficients) : coefficients_(coefficients) { trim(); }
+    explicit OmniPoly(std::vector<OmniInt> coefficients) : coefficients_(std::move(coefficients)) { trim(); }
+
+    // c * x^degree
+    static OmniPoly monomial(const OmniInt &c, size_t degree)
+    {
+        std::vector<OmniInt> coefficients(degree + 1);
+        coefficients[degree] = c;
+        return OmniPoly(std::move(coefficients));
+    }
+
+    // =================================================================
+    // Access - 访问
+    // =================================================================
+    long long degree() const { return static_cast<long long>(coefficients_.size()) - 1; }
+    bool is_zero() const { return coefficients_.empty(); }
+
+    // 第 i 次项的系数 (超出次数时为 0)
+    OmniInt operator[](size_t i) const { return i < coefficients_.size() ? coefficients_[i] : OmniInt(0); }
+    const std::vector<OmniInt> &coefficients() const { return coefficients_; }
+
+    // 首项系数，零多项式为 0
+    OmniInt leading() const { return is_zero() ? OmniInt(0) : coefficients_.back(); }
+
+    void set(size_t i, const OmniInt &c)
+    {
+        if (i >= coefficients_.size())
+            coefficients_.resize(i + 1);
+        coefficients_[i] = c;
+        trim();
+    }
+
+    // =================================================================
+    // Arithmetic - 算术运算
+    // =================================================================
+    OmniPoly operator-() const
+    {
+        OmniPoly result(*this);
+        for (size_t i = 0; i < result.coefficients_.size(); ++i)
+            result.coefficients_[i] = -result.coefficients_[i];
+        return result;
+    }
+
+    OmniPoly &operator+=(const OmniPoly &other)
+    {
+        if (coefficients_.size() < other.coefficients_.size())
+            coefficients_.resize(other.coefficients_.size());
+        for (size_t i = 0; i < other.coefficients_.size(); ++i)
+            coefficients_[i] += other.coefficients_[i];
+        trim();
+        return *this;
+    }
+
+    OmniPoly &operator-=(const OmniPoly &other)
+    {
+        if (coefficients_.size() < other.coefficients_.size())
+            coefficients_.resize(other.coefficients_.size());
+        for (size_t i = 0; i < other.coefficients_.size(); ++i)
+            coefficients_[i] -= other.coefficients_[i];
+        trim();
+        return *this;
+    }
+
+    OmniPoly &operator*=(const OmniPoly &other)
+    {
+        if (is_zero() || other.is_zero())
+        {
+            coefficients_.clear();
+            return *this;
+        }
+        if (other.coefficients_.size() == 1)
+            return *this *= other.coefficients_[0];
+        if (coefficients_.size() == 1)
+        {
+            const OmniInt c = coefficients_[0];
+            *this = other;
+            return *this *= c;
+        }
+
+        // 乘积的每个系数的绝对值不超过 max|a| * max|b| * min(na, nb) < 10^(width - 1)，
+        // 拆分时按平衡数位读出，只需要 10^width > 2 * 上界
+        const size_t width = max_digits() + other.max_digits() +
+                             omniint_detail::digit_count(std::min(coefficients_.size(), other.coefficients_.size())) +
+                             1;
+        const size_t count = coefficients_.size() + other.coefficients_.size() - 1;
+        // 平方时只打包一次；operator* 先复制左操作数，因此要比较系数而不只是比较地址
+        const bool square = &other == this || coefficients_ == other.coefficients_;
+        const OmniInt a = omniint_detail::kronecker_pack(coefficients_, width);
+        const OmniInt product = square ? a * a : a * omniint_detail::kronecker_pack(other.coefficients_, width);
+        coefficients_ = omniint_detail::kronecker_unpack(product, width, count);
+        trim();
+        return *this;
+    }
+
+    OmniPoly &operator*=(const OmniInt &c)
+    {
+        for (size_t i = 0; i < coefficients_.size(); ++i)
+            coefficients_[i] *= c;
+        trim();
+        return *this;
+    }
+
+    OmniPoly &operator*=(long long c) { return *this *= OmniInt(c); }
+
+    // 带余除法，见 divmod()
+    OmniPoly &operator/=(const OmniPoly &other)
+    {
+        OmniPoly remainder;
+        divmod(*this, other, *this, remainder);
+        return *this;
+    }
+
+    OmniPoly &operator%=(const OmniPoly &other)
+    {
+        OmniPoly quotient;
+        divmod(*this, other, quotient, *this);
+        return *this;
+    }
+
+    friend OmniPoly operator+(OmniPoly a, const OmniPoly &b) { return a += b; }
+    friend OmniPoly operator-(OmniPoly a, const OmniPoly &b) { return a -= b; }
+    friend OmniPoly operator*(OmniPoly a, const OmniPoly &b) { return a *= b; }
+    friend OmniPoly operator*(OmniPoly a, const OmniInt &c) { return a *= c; }
+    friend OmniPoly operator*(const OmniInt &c, OmniPoly a) { return a *= c; }
+    friend OmniPoly operator*(OmniPoly a, long long c) { return a *= c; }
+    friend OmniPoly operator*(long long c, OmniPoly a) { return a *= c; }
+    friend OmniPoly operator/(OmniPoly a, const OmniPoly &b) { return a /= b; }
+    friend OmniPoly operator%(OmniPoly a, const OmniPoly &b) { return a %= b; }
+
+    /**
+     * @brief 整系数的带余除法：a = quotient * b + remainder，deg(remainder) < deg(b)
+     *
+     * 每一步用余式的首项系数整除 b 的首项系数。b 的首项系数为 ±1 时总能整除；
+     * 否则商不一定是整系数多项式，此时抛出异常。quotient 与 remainder 可以是 a 或 b 本身。
+     *
+     * @throw std::runtime_error b 为零多项式
+     * @throw std::domain_error 某一步的首项系数不能整除 (商不是整系数多项式)
+     */
+    friend void divmod(const OmniPoly &a, const OmniPoly &b, OmniPoly &quotient, OmniPoly &remainder)
+    {
+        if (b.is_zero())
+            throw std::runtime_error("Division by zero polynomial");
+        const std::vector<OmniInt> divisor = b.coefficients_;
+        std::vector<OmniInt> r = a.coefficients_;
+        const OmniInt &lead = divisor.back();
+        const bool unit = lead.abs() == 1;
+        const size_t nb = divisor.size();
+
+        std::vector<OmniInt> q(r.size() >= nb ? r.size() - nb + 1 : 0);
+        for (size_t k = q.size(); k-- > 0;)
+        {
+            const OmniInt &top = r[k + nb - 1];
+            if (top.is_zero())
+                continue;
+            if (!unit && !(top % lead).is_zero())
+                throw std::domain_error("OmniPoly quotient does not have integer coefficients");
+            const OmniInt factor = unit ? (lead == 1 ? top : -top) : top / lead;
+            for (size_t j = 0; j < nb; ++j)
+                r[k + j] -= factor * divisor[j];
+            q[k] = factor;
+        }
+        r.resize(std::min(r.size(), nb - 1));
+        quotient = OmniPoly(std::move(q));
+        remainder = OmniPoly(std::move(r));
+    }
+
+    // =================================================================
+    // Evaluation - 求值
+    // =================================================================
+    // 秦九韶 (Horner) 算法
+    OmniInt evaluate(const OmniInt &x) const
+    {
+        OmniInt result = 0;
+        for (size_t i = coefficients_.size(); i-- > 0;)
+        {
+            result *= x;
+            result += coefficients_[i];
+        }
+        return result;
+    }
+
+    OmniInt operator()(const OmniInt &x) const { return evaluate(x); }
+
+    // =================================================================
+    // Comparison and Output - 比较与输出
+    // =================================================================
+    friend bool operator==(const OmniPoly &a, const OmniPoly &b) { return a.coefficients_ == b.coefficients_; }
+    friend bool operator!=(const OmniPoly &a, const OmniPoly &b) { return !(a == b); }
+
+    // 按次数从高到低输出，例如 "3*x^2 - x + 5"；零多项式输出 "0"
+    std::string toString() const
+    {
+        if (is_zero())
+            return "0";
+        std::string s;
+        for (size_t i = coefficients_.size(); i-- > 0;)
+        {
+            const OmniInt &c = coefficients_[i];
+            if (c.is_zero())
+                continue;
+            const bool negative = c < 0;
+            if (s.empty())
+                s += negative ? "-" : "";
+            else
+                s += negative ? " - " : " + ";
+            const OmniInt magnitude = c.abs();
+            if (i == 0 || magnitude != 1)
+                s += magnitude.toString() + (i == 0 ? "" : "*");
+            if (i >= 1)
+                s += "x";
+            if (i >= 2)
+                s += "^" + std::to_string(i);
+        }
+        return s;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const OmniPoly &p) { return os << p.toString(); }
+
+private:
+    void trim()
+    {
+        while (!coefficients_.empty() && coefficients_.back().is_zero())
+            coefficients_.pop_back();
+    }
+
+    size_t max_digits() const
+    {
+        size_t digits = 0;
+        for (size_t i = 0; i < coefficients_.size(); ++i)
+            digits = std::max(digits, coefficients_[i].digitCount());
+        return digits;
+    }
+
+    std::vector<OmniInt> coefficients_;
+};
+
+#endif // OmniPoly_H
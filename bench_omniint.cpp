@@ -0,0 +1,313 @@
+/*
+bench_omniint.cpp
+
+用同一组混合规模的工作负载 (乘法、除法、gcd、模幂、toString) 测量 OmniInt 的吞吐量，
+并在本机存在参考实现时给出相对吞吐量。
+
+参考实现:
+    - GMP (gmpxx):                编译时定义 OMNIINT_BENCH_GMP，并链接 -lgmpxx -lgmp
+    - boost::multiprecision:      检测到头文件时自动启用，定义 OMNIINT_BENCH_NO_BOOST 可关闭
+
+用法:
+    ./bench [--quick]
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+#include "OmniInt.h"
+
+#ifdef OMNIINT_BENCH_GMP
+#include <gmpxx.h>
+#endif
+
+#if !defined(OMNIINT_BENCH_NO_BOOST) && defined(__has_include)
+#if __has_include(<boost/multiprecision/cpp_int.hpp>)
+#include <boost/multiprecision/cpp_int.hpp>
+#define OMNIINT_BENCH_BOOST
+#endif
+#endif
+
+// =========================================================================
+// 工作负载
+// =========================================================================
+
+enum class Operation
+{
+    Multiply,
+    Divide,
+    Gcd,
+    PowMod,
+    ToString
+};
+
+static const char *operation_name(Operation op)
+{
+    switch (op)
+    {
+    case Operation::Multiply:
+        return "mul";
+    case Operation::Divide:
+        return "div";
+    case Operation::Gcd:
+        return "gcd";
+    case Operation::PowMod:
+        return "powmod";
+    case Operation::ToString:
+        return "toString";
+    }
+    return "?";
+}
+
+/**
+ * @brief 一组同规模的操作数 (十进制字符串)，所有实现都使用完全相同的输入
+ *
+ * 除法中 a 的位数是 b 的两倍；模幂中 a 为底数，b 为指数，m 为模数。
+ */
+struct Workload
+{
+    Operation op;
+    size_t digits;
+    std::vector<std::string> a, b, m;
+};
+
+static std::mt19937_64 g_rng(20250101);
+
+static std::string random_digits(size_t digits)
+{
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::string s(digits, '0');
+    s[0] = static_cast<char>('1' + digit(g_rng) % 9);
+    for (size_t i = 1; i < digits; ++i)
+    {
+        s[i] = static_cast<char>('0' + digit(g_rng));
+    }
+    return s;
+}
+
+static Workload make_workload(Operation op, size_t digits)
+{
+    Workload w;
+    w.op = op;
+    w.digits = digits;
+    for (int i = 0; i < 8; ++i)
+    {
+        w.a.push_back(random_digits(op == Operation::Divide ? 2 * digits : digits));
+        w.b.push_back(random_digits(digits));
+        w.m.push_back(random_digits(digits));
+    }
+    return w;
+}
+
+static void add_workloads(std::vector<Workload> &workloads, Operation op,
+                          const std::vector<size_t> &sizes, bool quick)
+{
+    // 快速模式下只运行每种运算中最小的两个规模
+    size_t count = quick ? std::min<size_t>(2, sizes.size()) : sizes.size();
+    for (size_t i = 0; i < count; ++i)
+        workloads.push_back(make_workload(op, sizes[i]));
+}
+
+static std::vector<Workload> make_workloads(bool quick)
+{
+    std::vector<Workload> workloads;
+    add_workloads(workloads, Operation::Multiply, {20, 200, 2000, 20000}, quick);
+    add_workloads(workloads, Operation::Divide, {20, 200, 2000}, quick);
+    add_workloads(workloads, Operation::Gcd, {20, 200}, quick);
+    add_workloads(workloads, Operation::PowMod, {20, 100}, quick);
+    add_workloads(workloads, Operation::ToString, {20, 200, 2000, 20000}, quick);
+    return workloads;
+}
+
+// =========================================================================
+// 各实现的适配器
+// =========================================================================
+
+// 通用的平方-乘模幂，用于没有内置模幂的实现
+template <typename T>
+static T generic_powmod(T base, T exponent, const T &modulus)
+{
+    T result = 1;
+    base = base % modulus;
+    while (exponent != 0)
+    {
+        if (exponent % 2 != 0)
+            result = result * base % modulus;
+        base = base * base % modulus;
+        exponent = exponent / 2;
+    }
+    return result;
+}
+
+struct OmniIntBackend
+{
+    typedef OmniInt number;
+    static const char *name() { return "OmniInt"; }
+    static number parse(const std::string &s) { return OmniInt(s); }
+    static number mul(const number &a, const number &b) { return a * b; }
+    static number div(const number &a, const number &b) { return a / b; }
+    static number gcd(const number &a, const number &b) { return ::gcd(a, b); }
+    static number powmod(const number &a, const number &e, const number &m) { return generic_powmod(a, e, m); }
+    static std::string str(const number &a) { return a.toString(); }
+};
+
+#ifdef OMNIINT_BENCH_GMP
+struct GmpBackend
+{
+    typedef mpz_class number;
+    static const char *name() { return "GMP"; }
+    static number parse(const std::string &s) { return mpz_class(s); }
+    static number mul(const number &a, const number &b) { return a * b; }
+    static number div(const number &a, const number &b) { return a / b; }
+    static number gcd(const number &a, const number &b) { return ::gcd(a, b); }
+    static number powmod(const number &a, const number &e, const number &m)
+    {
+        mpz_class r;
+        mpz_powm(r.get_mpz_t(), a.get_mpz_t(), e.get_mpz_t(), m.get_mpz_t());
+        return r;
+    }
+    static std::string str(const number &a) { return a.get_str(); }
+};
+#endif
+
+#ifdef OMNIINT_BENCH_BOOST
+struct BoostBackend
+{
+    typedef boost::multiprecision::cpp_int number;
+    static const char *name() { return "boost::cpp_int"; }
+    static number parse(const std::string &s) { return number(s); }
+    static number mul(const number &a, const number &b) { return a * b; }
+    static number div(const number &a, const number &b) { return a / b; }
+    static number gcd(const number &a, const number &b) { return boost::multiprecision::gcd(a, b); }
+    static number powmod(const number &a, const number &e, const number &m) { return boost::multiprecision::powm(a, e, m); }
+    static std::string str(const number &a) { return a.str(); }
+};
+#endif
+
+// =========================================================================
+// 计时
+// =========================================================================
+
+static double g_min_seconds = 0.2;
+static volatile size_t g_sink = 0; // 防止结果被编译器优化掉
+
+/**
+ * @brief 在给定实现上运行工作负载，返回每秒完成的运算次数
+ */
+template <typename Backend>
+static double run(const Workload &w)
+{
+    typedef typename Backend::number number;
+    std::vector<number> a, b, m;
+    for (size_t i = 0; i < w.a.size(); ++i)
+    {
+        a.push_back(Backend::parse(w.a[i]));
+        b.push_back(Backend::parse(w.b[i]));
+        m.push_back(Backend::parse(w.m[i]));
+    }
+
+    long long ops = 0;
+    auto start = std::chrono::steady_clock::now();
+    double seconds = 0;
+    do
+    {
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            switch (w.op)
+            {
+            case Operation::Multiply:
+                g_sink += Backend::mul(a[i], b[i]) != 0;
+                break;
+            case Operation::Divide:
+                g_sink += Backend::div(a[i], b[i]) != 0;
+                break;
+            case Operation::Gcd:
+                g_sink += Backend::gcd(a[i], b[i]) != 0;
+                break;
+            case Operation::PowMod:
+                g_sink += Backend::powmod(a[i], b[i], m[i]) != 0;
+                break;
+            case Operation::ToString:
+                g_sink += Backend::str(a[i]).size();
+                break;
+            }
+        }
+        ops += a.size();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (seconds < g_min_seconds);
+    return ops / seconds;
+}
+
+struct Reference
+{
+    const char *name;
+    double (*run)(const Workload &);
+};
+
+// =========================================================================
+// 主函数
+// =========================================================================
+
+int main(int argc, char **argv)
+{
+    bool quick = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--quick") == 0)
+            quick = true;
+    }
+    if (quick)
+        g_min_seconds = 0.05;
+
+    std::vector<Reference> references;
+#ifdef OMNIINT_BENCH_GMP
+    references.push_back(Reference{GmpBackend::name(), &run<GmpBackend>});
+#endif
+#ifdef OMNIINT_BENCH_BOOST
+    references.push_back(Reference{BoostBackend::name(), &run<BoostBackend>});
+#endif
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "     OmniInt Benchmark                  " << std::endl;
+    std::cout << "========================================" << std::endl;
+    if (references.empty())
+    {
+        std::cout << "No reference implementation available; reporting OmniInt only." << std::endl;
+    }
+
+    std::cout << std::left << std::setw(10) << "op" << std::right << std::setw(8) << "digits"
+              << std::setw(16) << "OmniInt ops/s";
+    for (size_t r = 0; r < references.size(); ++r)
+    {
+        std::cout << std::setw(24) << (std::string(references[r].name) + " ops/s")
+                  << std::setw(10) << "relative";
+    }
+    std::cout << std::endl;
+
+    std::vector<Workload> workloads = make_workloads(quick);
+    std::cout << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < workloads.size(); ++i)
+    {
+        const Workload &w = workloads[i];
+        double omni = run<OmniIntBackend>(w);
+        std::cout << std::left << std::setw(10) << operation_name(w.op) << std::right
+                  << std::setw(8) << w.digits << std::setw(16) << omni;
+        for (size_t r = 0; r < references.size(); ++r)
+        {
+            double ref = references[r].run(w);
+            // relative = OmniInt 吞吐量 / 参考实现吞吐量，1.0 表示持平
+            std::cout << std::setw(24) << ref << std::setw(10) << std::setprecision(4)
+                      << omni / ref << std::setprecision(1);
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "========================================" << std::endl;
+    return 0;
+}
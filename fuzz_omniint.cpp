@@ -0,0 +1,485 @@
+/*
+fuzz_omniint.cpp
+
+随机差分测试：在不同规模的随机操作数上，把各算法层级的结果与朴素 (schoolbook)
+参考实现以及 long long 运算进行比较；同时测量每个层级在固定负载上的耗时，
+与基准文件比较以发现性能回退。
+
+用法:
+    ./fuzz [--seed N] [--iterations N] [--record FILE] [--baseline FILE] [--tolerance X]
+
+    --record FILE     把本次各层级的耗时写入 FILE，作为以后的基准
+    --baseline FILE   与 FILE 中的耗时比较，任一层级慢于基准 (1 + X) 倍时失败 (X 默认为 0.25)
+
+出现结果不一致或性能回退时返回非零退出码。
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+// 把阈值宏替换为变量，以便强制使用某一层级的算法
+static size_t g_karatsuba_threshold = 64;
+#define OMNIINT_KARATSUBA_THRESHOLD g_karatsuba_threshold
+static size_t g_ntt_threshold = 1000;
+#define OMNIINT_NTT_THRESHOLD g_ntt_threshold
+static size_t g_fft_threshold = 1000;
+#define OMNIINT_FFT_THRESHOLD g_fft_threshold
+static size_t g_ssa_threshold = std::numeric_limits<size_t>::max();
+#define OMNIINT_SSA_THRESHOLD g_ssa_threshold
+
+#include "OmniInt.h"
+#include "OmniIntSum.h"
+#include "OmniIntDigits.h"
+
+static const size_t kSchoolbookOnly = std::numeric_limits<size_t>::max();
+static const size_t kTransformDisabled = std::numeric_limits<size_t>::max();
+
+// =========================================================================
+// 随机操作数
+// =========================================================================
+
+static std::mt19937_64 g_rng;
+static int g_failures = 0;
+
+struct SizeClass
+{
+    const char *name;
+    size_t min_digits;
+    size_t max_digits;
+};
+
+static const SizeClass kSizeClasses[] = {
+    {"tiny", 1, 9},
+    {"small", 10, 63},
+    {"medium", 64, 400},
+    {"large", 401, 2000},
+};
+
+static size_t random_between(size_t lo, size_t hi)
+{
+    return std::uniform_int_distribution<size_t>(lo, hi)(g_rng);
+}
+
+/**
+ * @brief 生成一个随机操作数的十进制字符串
+ *
+ * 除均匀随机的数字外，也会生成全 9、10 的幂等容易暴露进位错误的特殊形式。
+ */
+static std::string random_digits(size_t digits)
+{
+    std::string s(digits, '0');
+    switch (random_between(0, 7))
+    {
+    case 0: // 全 9
+        s.assign(digits, '9');
+        break;
+    case 1: // 10 的幂
+        s[0] = '1';
+        break;
+    case 2: // 大量连续的 0
+        for (size_t i = 0; i < digits; ++i)
+            s[i] = random_between(0, 9) == 0 ? static_cast<char>('0' + random_between(1, 9)) : '0';
+        s[0] = '1';
+        break;
+    default:
+        for (size_t i = 0; i < digits; ++i)
+            s[i] = static_cast<char>('0' + random_between(0, 9));
+        s[0] = static_cast<char>('1' + random_between(0, 8));
+        break;
+    }
+    return s;
+}
+
+static OmniInt random_operand(const SizeClass &size_class, bool allow_negative = true)
+{
+    std::string s = random_digits(random_between(size_class.min_digits, size_class.max_digits));
+    if (allow_negative && random_between(0, 1))
+        s.insert(s.begin(), '-');
+    return OmniInt(s);
+}
+
+// =========================================================================
+// 检查辅助函数
+// =========================================================================
+
+static void check(bool condition, const std::string &what, const OmniInt &a, const OmniInt &b)
+{
+    if (condition)
+        return;
+    ++g_failures;
+    if (g_failures <= 20)
+    {
+        std::cout << "[FAIL] " << what << "\n  a = " << a << "\n  b = " << b << std::endl;
+    }
+}
+
+/**
+ * @brief 在作用域内临时修改 NTT、FFT 与 SSA 的阈值
+ */
+class TransformThresholds
+{
+public:
+    TransformThresholds(size_t ntt, size_t fft, size_t ssa = kTransformDisabled)
+        : saved_ntt_(g_ntt_threshold), saved_fft_(g_fft_threshold), saved_ssa_(g_ssa_threshold)
+    {
+        g_ntt_threshold = ntt;
+        g_fft_threshold = fft;
+        g_ssa_threshold = ssa;
+    }
+    ~TransformThresholds()
+    {
+        g_ntt_threshold = saved_ntt_;
+        g_fft_threshold = saved_fft_;
+        g_ssa_threshold = saved_ssa_;
+    }
+
+private:
+    size_t saved_ntt_, saved_fft_, saved_ssa_;
+};
+
+static OmniInt multiply_with_threshold(const OmniInt &a, const OmniInt &b, size_t threshold,
+                                       size_t ntt_threshold = kTransformDisabled,
+                                       size_t fft_threshold = kTransformDisabled,
+                                       size_t ssa_threshold = kTransformDisabled)
+{
+    TransformThresholds transforms(ntt_threshold, fft_threshold, ssa_threshold);
+    size_t saved = g_karatsuba_threshold;
+    g_karatsuba_threshold = threshold;
+    OmniInt product = a * b;
+    g_karatsuba_threshold = saved;
+    return product;
+}
+
+// 与 long long 的结果比较 (仅用于 tiny 规模)
+static void check_against_long_long(const OmniInt &a, const OmniInt &b)
+{
+    long long x = a.toLongLong(), y = b.toLongLong();
+    check((a + b).toLongLong() == x + y, "add vs long long", a, b);
+    check((a - b).toLongLong() == x - y, "sub vs long long", a, b);
+    check((a * b).toLongLong() == x * y, "mul vs long long", a, b);
+    if (y != 0)
+    {
+        check((a / b).toLongLong() == x / y, "div vs long long", a, b);
+        check((a % b).toLongLong() == x % y, "mod vs long long", a, b);
+    }
+    check((a < b) == (x < y), "compare vs long long", a, b);
+}
+
+static void check_multiplication_tiers(const OmniInt &a, const OmniInt &b)
+{
+    OmniInt reference = multiply_with_threshold(a, b, kSchoolbookOnly);
+    check(multiply_with_threshold(a, b, 4) == reference, "karatsuba (threshold 4) vs schoolbook", a, b);
+    check(multiply_with_threshold(a, b, 64) == reference, "karatsuba (threshold 64) vs schoolbook", a, b);
+    check(multiply_with_threshold(a, b, 64, 1) == reference, "ntt (threshold 1) vs schoolbook", a, b);
+    check(multiply_with_threshold(a, b, 64, 64) == reference, "ntt (threshold 64) vs schoolbook", a, b);
+    check(multiply_with_threshold(a, b, 64, kTransformDisabled, 1) == reference, "fft (threshold 1) vs schoolbook", a, b);
+    check(multiply_with_threshold(a, b, 64, kTransformDisabled, 64) == reference, "fft (threshold 64) vs schoolbook",
+          a, b);
+    check(multiply_with_threshold(a, b, 64, kTransformDisabled, kTransformDisabled, 1) == reference,
+          "ssa (threshold 1) vs schoolbook", a, b);
+    check(multiply_with_threshold(a, b, 64, 64, kTransformDisabled, 64) == reference, "ssa (threshold 64) vs schoolbook",
+          a, b);
+
+    // 预变换的乘数在 mul() 之间复用缓存的变换
+    {
+        TransformThresholds transforms(1, kTransformDisabled);
+        OmniIntPreparedMultiplier prepared(a);
+        check(prepared.mul(b) == reference && prepared.mul(b) == reference, "prepared ntt vs schoolbook", a, b);
+    }
+    {
+        TransformThresholds transforms(kTransformDisabled, 1);
+        OmniIntPreparedMultiplier prepared(a);
+        check(prepared.mul(b) == reference && prepared.mul(b) == reference, "prepared fft vs schoolbook", a, b);
+    }
+    check(a * b == reference, "default multiply vs schoolbook", a, b);
+    check(b * a == reference, "multiply commutes", a, b);
+}
+
+// 截断乘法与完整乘积的对应部分比较
+static void check_truncated_products(const OmniInt &a, const OmniInt &b)
+{
+    const size_t total = a.abs().toString().size() + b.abs().toString().size();
+    const size_t n = random_between(0, total + 2);
+    const std::string product = (a * b).abs().toString();
+    const bool negative = (a < 0) != (b < 0);
+
+    std::string low = product.size() > n ? product.substr(product.size() - n) : product;
+    OmniInt expected_low = n == 0 ? OmniInt(0) : OmniInt(low);
+    const size_t shift = n >= total ? 0 : total - n;
+    OmniInt expected_high = product.size() > shift ? OmniInt(product.substr(0, product.size() - shift)) : OmniInt(0);
+    if (negative)
+    {
+        expected_low = -expected_low;
+        expected_high = -expected_high;
+    }
+
+    for (size_t threshold : {kSchoolbookOnly, size_t(4), size_t(64)})
+    {
+        size_t saved = g_karatsuba_threshold;
+        g_karatsuba_threshold = threshold;
+        check(mul_low(a, b, n) == expected_low, "mul_low vs full product", a, b);
+        check(mul_high(a, b, n) == expected_high, "mul_high vs full product", a, b);
+        g_karatsuba_threshold = saved;
+    }
+
+    // 达到 NTT / FFT 阈值时改用完整乘积
+    TransformThresholds transforms(1, 1);
+    check(mul_low(a, b, n) == expected_low, "mul_low (transform) vs full product", a, b);
+    check(mul_high(a, b, n) == expected_high, "mul_high (transform) vs full product", a, b);
+    TransformThresholds ssa(kTransformDisabled, kTransformDisabled, 1);
+    check(mul_low(a, b, n) == expected_low, "mul_low (ssa) vs full product", a, b);
+    check(mul_high(a, b, n) == expected_high, "mul_high (ssa) vs full product", a, b);
+}
+
+static void check_identities(const OmniInt &a, const OmniInt &b)
+{
+    check((a + b) - b == a, "(a + b) - b == a", a, b);
+    check(a + b == b + a, "addition commutes", a, b);
+    check(-(a - b) == b - a, "-(a - b) == b - a", a, b);
+
+    if (!b.is_zero())
+    {
+        OmniInt q = a / b, r = a % b;
+        check(q * b + r == a, "q * b + r == a", a, b);
+        check(r.abs() < b.abs(), "|r| < |b|", a, b);
+        check(r.is_zero() || ((r < 0) == (a < 0)), "sign(r) == sign(a)", a, b);
+    }
+
+    OmniInt n = a.abs();
+    OmniInt root = sqrt(n);
+    check(root * root <= n && (root + 1) * (root + 1) > n, "sqrt bounds", a, b);
+
+    check(OmniInt(a.toString()) == a, "toString/parse round trip", a, b);
+    std::stringstream ss;
+    OmniInt streamed;
+    ss << a;
+    ss >> streamed;
+    check(streamed == a, "stream round trip", a, b);
+
+    std::stringstream chunked;
+    write_digits(chunked, a, random_between(1, 64));
+    check(chunked.str() == a.toString(), "chunked digit output", a, b);
+}
+
+static void check_gcd(const OmniInt &a, const OmniInt &b)
+{
+    OmniInt g = gcd(a, b);
+    if (g.is_zero())
+    {
+        check(a.is_zero() && b.is_zero(), "gcd == 0 only for (0, 0)", a, b);
+        return;
+    }
+    check(a % g == 0 && b % g == 0, "gcd divides both", a, b);
+    check(gcd(a / g, b / g) == 1, "gcd(a / g, b / g) == 1", a, b);
+}
+
+// 延迟进位的累加器与逐次 += 的结果比较
+static void check_sum(const SizeClass &size_class, int terms)
+{
+    OmniIntSum sum;
+    OmniInt reference;
+    for (int i = 0; i < terms; ++i)
+    {
+        OmniInt term = random_operand(size_class);
+        if (random_between(0, 3) == 0)
+        {
+            sum -= term;
+            reference -= term;
+        }
+        else
+        {
+            sum += term;
+            reference += term;
+        }
+    }
+    check(sum.value() == reference, "OmniIntSum vs repeated +=", reference, OmniInt(terms));
+}
+
+static void run_differential(int iterations)
+{
+    for (const SizeClass &size_class : kSizeClasses)
+    {
+        // 大规模的除法与 gcd 较慢，按规模减少迭代次数
+        int count = size_class.max_digits <= 63 ? iterations : std::max(1, iterations / 10);
+        for (int i = 0; i < count; ++i)
+        {
+            OmniInt a = random_operand(size_class);
+            OmniInt b = random_operand(size_class);
+            if (random_between(0, 15) == 0)
+                b = 0;
+
+            if (size_class.max_digits <= 9)
+                check_against_long_long(a, b);
+            check_multiplication_tiers(a, b);
+            check_truncated_products(a, b);
+            check_identities(a, b);
+            if (size_class.max_digits <= 63)
+                check_gcd(a, b);
+        }
+
+        // 长度悬殊的乘数：较短的乘数取自不大于当前规模的任一类别
+        const size_t class_index = &size_class - kSizeClasses;
+        for (int i = 0; i < count; ++i)
+        {
+            OmniInt a = random_operand(size_class);
+            OmniInt b = random_operand(kSizeClasses[random_between(0, class_index)]);
+            check_multiplication_tiers(a, b);
+        }
+        check_sum(size_class, count);
+        std::cout << "[DONE] differential checks: " << size_class.name << std::endl;
+    }
+}
+
+// =========================================================================
+// 分层计时与性能回退检查
+// =========================================================================
+
+/**
+ * @brief 测量 fn 的单次耗时 (纳秒)，取 5 轮中的最小值
+ */
+static double time_ns(const std::function<void()> &fn)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int round = 0; round < 5; ++round)
+    {
+        long long reps = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::duration elapsed;
+        do
+        {
+            fn();
+            ++reps;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed < std::chrono::milliseconds(5));
+        best = std::min(best, std::chrono::duration<double, std::nano>(elapsed).count() / reps);
+    }
+    return best;
+}
+
+static std::map<std::string, double> measure_tiers()
+{
+    // 固定的种子，保证每次运行使用相同的负载
+    g_rng.seed(12345);
+    const SizeClass fixed_small = {"fixed", 40, 40};
+    const SizeClass fixed_large = {"fixed", 1000, 1000};
+    const OmniInt a = random_operand(fixed_small, false), b = random_operand(fixed_small, false);
+    const OmniInt c = random_operand(fixed_large, false), d = random_operand(fixed_large, false);
+    const OmniInt e = c * d;
+    const std::string text = e.toString();
+
+    std::map<std::string, double> tiers;
+    tiers["mul_schoolbook"] = time_ns([&]()
+                                      { multiply_with_threshold(a, b, kSchoolbookOnly); });
+    tiers["mul_karatsuba"] = time_ns([&]()
+                                     { multiply_with_threshold(c, d, 64); });
+    tiers["mul_ntt"] = time_ns([&]()
+                               { multiply_with_threshold(c, d, 64, 1); });
+    tiers["mul_fft"] = time_ns([&]()
+                               { multiply_with_threshold(c, d, 64, kTransformDisabled, 1); });
+    tiers["mul_ssa"] = time_ns([&]()
+                               { multiply_with_threshold(c, d, 64, kTransformDisabled, kTransformDisabled, 1); });
+    tiers["divide"] = time_ns([&]()
+                              { OmniInt q = e / c; });
+    tiers["sqrt"] = time_ns([&]()
+                            { OmniInt r = sqrt(c); });
+    tiers["gcd"] = time_ns([&]()
+                           { OmniInt g = gcd(a, b); });
+    tiers["from_string"] = time_ns([&]()
+                                   { OmniInt x(text); });
+    tiers["to_string"] = time_ns([&]()
+                                 { std::string s = e.toString(); });
+    return tiers;
+}
+
+static std::map<std::string, double> read_tiers(const std::string &path)
+{
+    std::map<std::string, double> tiers;
+    std::ifstream in(path.c_str());
+    std::string name;
+    double ns;
+    while (in >> name >> ns)
+        tiers[name] = ns;
+    return tiers;
+}
+
+// =========================================================================
+// 主函数
+// =========================================================================
+
+int main(int argc, char **argv)
+{
+    unsigned long long seed = std::random_device()();
+    int iterations = 200;
+    double tolerance = 0.25;
+    std::string record_path, baseline_path;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--seed") == 0)
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--iterations") == 0)
+            iterations = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--record") == 0)
+            record_path = argv[i + 1];
+        else if (std::strcmp(argv[i], "--baseline") == 0)
+            baseline_path = argv[i + 1];
+        else if (std::strcmp(argv[i], "--tolerance") == 0)
+            tolerance = std::atof(argv[i + 1]);
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "     OmniInt Differential Fuzzing       " << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "seed = " << seed << ", iterations = " << iterations << std::endl;
+
+    g_rng.seed(seed);
+    run_differential(iterations);
+
+    std::cout << "\n--- Per-tier timing (ns per operation) ---\n";
+    std::map<std::string, double> tiers = measure_tiers();
+    std::map<std::string, double> baseline;
+    if (!baseline_path.empty())
+        baseline = read_tiers(baseline_path);
+
+    int regressions = 0;
+    for (const auto &tier : tiers)
+    {
+        std::cout << "  " << tier.first << ": " << tier.second;
+        auto it = baseline.find(tier.first);
+        if (it != baseline.end())
+        {
+            double ratio = tier.second / it->second;
+            std::cout << " (baseline " << it->second << ", x" << ratio << ")";
+            if (ratio > 1.0 + tolerance)
+            {
+                std::cout << " [REGRESSION]";
+                ++regressions;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    if (!record_path.empty())
+    {
+        std::ofstream out(record_path.c_str());
+        for (const auto &tier : tiers)
+            out << tier.first << " " << tier.second << "\n";
+        std::cout << "Timings recorded to " << record_path << std::endl;
+    }
+
+    std::cout << "\n----------------------------------------" << std::endl;
+    std::cout << "  Mismatches: " << g_failures << std::endl;
+    std::cout << "  Regressions: " << regressions << std::endl;
+    std::cout << "========================================" << std::endl;
+    return (g_failures > 0 || regressions > 0) ? 1 : 0;
+}
@@ -0,0 +1,83 @@
+/*
+fuzz_parse.cpp
+
+字符串解析的 libFuzzer 入口。任意字节序列要么被拒绝 (抛出 std::invalid_argument)，
+要么被解析为一个 OmniInt，且其 toString() 与输入的规范形式一致。
+
+使用 libFuzzer:
+    clang++ -std=c++11 -g -O1 -fsanitize=fuzzer,address fuzz_parse.cpp -o fuzz_parse
+    ./fuzz_parse corpus/
+
+没有 libFuzzer 时，定义 OMNIINT_FUZZ_STANDALONE 编译，可逐个重放语料文件:
+    g++ -std=c++11 -DOMNIINT_FUZZ_STANDALONE fuzz_parse.cpp -o fuzz_parse
+    ./fuzz_parse corpus/input1 corpus/input2 ...
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <stdexcept>
+
+#include "OmniInt.h"
+
+// 按 OmniInt 的语法规则计算输入的规范形式，非法输入返回空字符串
+static std::string canonical_form(const std::string &s)
+{
+    size_t start = 0;
+    bool negative = false;
+    if (!s.empty() && (s[0] == '+' || s[0] == '-'))
+    {
+        negative = (s[0] == '-');
+        start = 1;
+    }
+    if (start == s.size())
+        return "";
+    for (size_t i = start; i < s.size(); ++i)
+    {
+        if (s[i] < '0' || s[i] > '9')
+            return "";
+    }
+    size_t first = s.find_first_not_of('0', start);
+    if (first == std::string::npos)
+        return "0";
+    return (negative ? "-" : "") + s.substr(first);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const std::string input(reinterpret_cast<const char *>(data), size);
+    const std::string expected = canonical_form(input);
+
+    try
+    {
+        OmniInt n(input);
+        if (expected.empty() || n.toString() != expected)
+            std::abort();
+        if (OmniInt(n.toString()) != n)
+            std::abort();
+    }
+    catch (const std::invalid_argument &)
+    {
+        if (!expected.empty())
+            std::abort();
+    }
+    return 0;
+}
+
+#ifdef OMNIINT_FUZZ_STANDALONE
+#include <fstream>
+#include <iterator>
+#include <iostream>
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::ifstream in(argv[i], std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(content.data()), content.size());
+    }
+    std::cout << "Replayed " << (argc - 1) << " inputs." << std::endl;
+    return 0;
+}
+#endif
@@ -7,8 +7,49 @@
 #include <climits>
 #include <chrono>  // NEW: 计时
 #include <iomanip> // NEW: 小数格式
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+
+#ifndef OMNIINT_COMPILED_LIB
+// 仅头文件模式下把阈值宏替换为变量 (同 fuzz_omniint.cpp)，以便在单个用例中强制使用较早的乘法内核；
+// 默认值与 OmniInt.h 相同。链接预编译库时阈值已编译进库中，相关用例不运行
+static size_t g_ntt_threshold = 192;
+#define OMNIINT_NTT_THRESHOLD g_ntt_threshold
+static size_t g_fft_threshold = 128;
+#define OMNIINT_FFT_THRESHOLD g_fft_threshold
+static size_t g_ssa_threshold = std::numeric_limits<size_t>::max();
+#define OMNIINT_SSA_THRESHOLD g_ssa_threshold
+
+// 在作用域内临时修改一个阈值
+struct threshold_override
+{
+    threshold_override(size_t &threshold, size_t value) : threshold_(threshold), saved_(threshold) { threshold_ = value; }
+    ~threshold_override() { threshold_ = saved_; }
+    size_t &threshold_;
+    size_t saved_;
+};
+#endif
 
 #include "OmniInt.h"
+#include "OmniIntSum.h"
+#include "OmniIntAccumulator.h"
+#include "OmniIntAsync.h"
+#include "OmniIntDigits.h"
+#include "OmniIntOutOfCore.h"
+#include "OmniIntCheckpoint.h"
+#include "OmniPoly.h"
+// 调低 Strassen 阈值，使较小的测试矩阵也能走到分块乘法
+#define OMNIMATRIX_STRASSEN_THRESHOLD 4
+#include "OmniMatrix.h"
+// 同样调低阈值，让较短的测试数据也经过递归的 half-GCD
+#define OMNIINT_HGCD_THRESHOLD 40
+#include "OmniIntContinuedFraction.h"
+#include "OmniIntRandom.h"
+#include <fstream>
+#include <cstdio>
+#include <thread>
 
 // 全局计数器，用于统计测试结果
 int tests_passed = 0;
@@ -135,6 +176,7 @@ void test_arithmetic_operators()
     test_case("Addition (pos + neg, result pos)", (a + d) == OmniInt("877"));
     test_case("Addition (pos + neg, result neg)", (b + c) == OmniInt("-877"));
     test_case("Addition (result zero)", (a + c) == OmniInt("0"));
+    test_case("Addition (neg + zero)", (c + 0) == c);
 
     // Subtraction
     test_case("Subtraction (pos - pos, result pos)", (a - b) == OmniInt("877"));
@@ -142,6 +184,7 @@ void test_arithmetic_operators()
     test_case("Subtraction (pos - neg)", (a - d) == OmniInt("1123"));
     test_case("Subtraction (neg - pos)", (c - a) == OmniInt("-2000"));
     test_case("Subtraction (result zero)", (a - a) == OmniInt("0"));
+    test_case("Subtraction (neg - zero)", (c - 0) == c);
 
     // Multiplication
     OmniInt big1("123456789"), big2("987654321");
@@ -332,6 +375,1132 @@ void test_gcd()
     test_case("gcd(large numbers)", gcd(a, b) == g);
 }
 
+// 逐次相乘的参考实现
+size_t naive_ilog(const OmniInt &n, const OmniInt &base)
+{
+    size_t k = 0;
+    for (OmniInt power = base; power <= n; power *= base)
+        ++k;
+    return k;
+}
+
+void test_ilog()
+{
+    std::cout << "\n--- Testing Integer Logarithms ---\n";
+
+    test_case("ilog small values", ilog(1, 2) == 0 && ilog(7, 2) == 2 && ilog(8, 2) == 3 && ilog(80, 3) == 3 && ilog(81, 3) == 4);
+    test_case("ilog2 / ilog10", ilog2(OmniInt(1024)) == 10 && ilog2(OmniInt(1023)) == 9 &&
+                                    ilog10(OmniInt("1000")) == 3 && ilog10(OmniInt(999)) == 2);
+
+    // 恰好是幂以及幂的相邻值：估计值离整数最近，需要精确比较
+    bool powers_ok = true;
+    const long long bases[] = {2, 3, 7, 10, 36, 1000000007};
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); ++i)
+    {
+        for (size_t k = 1; k < 300; k += 37)
+        {
+            OmniInt p = 1;
+            for (size_t j = 0; j < k; ++j)
+                p *= bases[i];
+            powers_ok = powers_ok && ilog(p, bases[i]) == k && ilog(p + 1, bases[i]) == k && ilog(p - 1, bases[i]) == k - 1 &&
+                        is_power_of(p, bases[i]) && !is_power_of(p + 1, bases[i]) && (k == 1 || !is_power_of(p - 1, bases[i]));
+        }
+    }
+    test_case("ilog and is_power_of at exact powers", powers_ok);
+
+    // 上万位时估计值的误差窗口按机器精度计算，幂的相邻值仍须落在窗口内并精确比较
+    const OmniInt two_power = omniint_detail::cached_power(OmniInt(2), 33220);
+    test_case("ilog2 next to a 10000-digit power", ilog2(two_power) == 33220 && ilog2(two_power - 1) == 33219 &&
+                                                       ilog2(two_power + 1) == 33220 && is_power_of(two_power, 2) &&
+                                                       !is_power_of(two_power - 1, 2));
+
+    OmniInt big("98765432109876543210987654321098765432109876543210987654321098765432109876543210");
+    test_case("ilog matches repeated multiplication", ilog(big, 2) == naive_ilog(big, 2) && ilog(big, 12345) == naive_ilog(big, 12345) &&
+                                                           ilog(big * big, OmniInt("123456789012345678901234567")) ==
+                                                               naive_ilog(big * big, OmniInt("123456789012345678901234567")));
+    test_case("is_power_of rejects", !is_power_of(0, 2) && !is_power_of(-8, 2) && is_power_of(1, 5) && !is_power_of(big, 3));
+
+    try
+    {
+        ilog(0, 2);
+        test_case("ilog of zero throws", false);
+    }
+    catch (const std::domain_error &)
+    {
+        test_case("ilog of zero throws", true);
+    }
+    try
+    {
+        ilog(100, 1);
+        test_case("ilog base 1 throws", false);
+    }
+    catch (const std::invalid_argument &)
+    {
+        test_case("ilog base 1 throws", true);
+    }
+}
+
+void test_floating_conversion()
+{
+    std::cout << "\n--- Testing Floating-Point Conversion ---\n";
+
+    test_case("to_double small values", OmniInt(0).to_double() == 0.0 && OmniInt(-123).to_double() == -123.0 &&
+                                            OmniInt("9007199254740993").to_double() == 9007199254740992.0 && // 2^53 + 1，平局取偶
+                                            OmniInt("9007199254740995").to_double() == 9007199254740996.0);
+
+    // strtod / strtold 是正确舍入的，作为参考
+    bool double_ok = true, long_double_ok = true;
+    OmniIntRandomEngine rng(11);
+    for (int i = 0; i < 300; ++i)
+    {
+        OmniInt n = random_digits(1 + i % 310, rng);
+        if (i % 2)
+            n = -n;
+        const std::string text = n.toString();
+        double_ok = double_ok && n.to_double() == std::strtod(text.c_str(), nullptr);
+        long_double_ok = long_double_ok && n.to_long_double() == std::strtold(text.c_str(), nullptr);
+    }
+    test_case("to_double is correctly rounded", double_ok);
+    test_case("to_long_double is correctly rounded", long_double_ok);
+
+    // 恰好在两个 double 正中间：只有精确比较才能判定
+    const OmniInt p900 = OmniInt::from_double(std::ldexp(1.0, 900)), half_ulp = OmniInt::from_double(std::ldexp(1.0, 847));
+    test_case("to_double ties to even on long values", (p900 + half_ulp).to_double() == std::ldexp(1.0, 900) &&
+                                                           (p900 + half_ulp + 1).to_double() == std::ldexp(1.0, 900) + std::ldexp(1.0, 848) &&
+                                                           (p900 + half_ulp * 3).to_double() == std::ldexp(1.0, 900) + std::ldexp(1.0, 849));
+    const OmniInt huge = random_digits(400, rng) + OmniInt(std::string(400, '9'));
+    test_case("to_double overflows to infinity", huge.to_double() == std::numeric_limits<double>::infinity() &&
+                                                     (-huge).to_double() == -std::numeric_limits<double>::infinity());
+
+    // 3 * 2^200000 有六万多位，mantissa 应恰好为 0.75
+    long long exponent = 0;
+    const OmniInt big = OmniInt::from_double(3.0) * OmniInt::from_double(std::ldexp(1.0, 1000));
+    OmniInt scaled = big;
+    for (int i = 0; i < 199; ++i)
+        scaled *= OmniInt::from_double(std::ldexp(1.0, 1000));
+    double mantissa = scaled.to_double_2exp(exponent);
+    bool two_exp_ok = mantissa == 0.75 && exponent == 200002;
+    mantissa = (-scaled - 1).to_double_2exp(exponent);
+    two_exp_ok = two_exp_ok && mantissa == -0.75 && exponent == 200002;
+    mantissa = OmniInt("1000").to_double_2exp(exponent);
+    two_exp_ok = two_exp_ok && mantissa == 1000.0 / 1024 && exponent == 10 && OmniInt(0).to_double_2exp(exponent) == 0.0;
+    test_case("to_double_2exp", two_exp_ok);
+
+    test_case("from_double truncates", OmniInt::from_double(1e20) == OmniInt("100000000000000000000") &&
+                                           OmniInt::from_double(-2.5) == -2 && OmniInt::from_double(0.9) == 0 &&
+                                           OmniInt::from_double(std::ldexp(1.0, 70)) == OmniInt("1180591620717411303424") &&
+                                           OmniInt::from_long_double(std::ldexp(-3.0L, 80)) == OmniInt("-3626777458843887524118528"));
+    try
+    {
+        OmniInt::from_double(std::numeric_limits<double>::quiet_NaN());
+        test_case("from_double(NaN) throws", false);
+    }
+    catch (const std::domain_error &)
+    {
+        test_case("from_double(NaN) throws", true);
+    }
+}
+
+void test_large_multiplication()
+{
+    std::cout << "\n--- Testing Large Multiplication (Karatsuba) ---\n";
+
+    // (10^k - 1)^2 = 10^2k - 2 * 10^k + 1，即 (k-1) 个 9、一个 8、(k-1) 个 0、一个 1
+    const size_t k = 500;
+    OmniInt nines(std::string(k, '9'));
+    std::string expected = std::string(k - 1, '9') + "8" + std::string(k - 1, '0') + "1";
+    test_case("Karatsuba (10^k - 1)^2", (nines * nines).toString() == expected);
+
+    // 长度悬殊的乘数
+    OmniInt small_factor("123456789");
+    OmniInt product = nines * small_factor;
+    test_case("Karatsuba (unbalanced operands)", product / small_factor == nines && product % small_factor == 0);
+
+    // 较短的乘数也超过阈值时，较长的乘数按较短乘数的长度分块 (最后一块不满)
+    OmniInt long_nines(std::string(2050, '9'));
+    OmniInt factor = OmniInt(std::string(100, '7')) + 12345;
+    OmniInt shifted(factor.toString() + std::string(2050, '0'));
+    test_case("Karatsuba (chunked unbalanced operands)", long_nines * factor == shifted - factor);
+
+    // 较长的乘数为奇数位、较短的乘数恰好为其一半 (向上取整)：也走分块，不做平衡拆分
+    OmniInt odd_nines(std::string(199, '9'));
+    OmniInt half_factor = OmniInt(std::string(100, '3')) + 987654321;
+    OmniInt odd_shifted(half_factor.toString() + std::string(199, '0'));
+    test_case("Karatsuba (odd length, shorter operand = half)", odd_nines * half_factor == odd_shifted - half_factor &&
+                                                                   half_factor * odd_nines == odd_shifted - half_factor);
+
+    // 符号处理
+    test_case("Karatsuba (sign)", (-nines) * nines == -(nines * nines));
+}
+
+// 乘积 |a * b| 的十进制表示去掉最低的 (la + lb - n) 位
+static OmniInt expected_high_part(const OmniInt &a, const OmniInt &b, size_t n)
+{
+    std::string product = (a * b).abs().toString();
+    size_t shift = a.digitCount() + b.digitCount() - n;
+    return shift >= product.size() ? OmniInt(0) : OmniInt(product.substr(0, product.size() - shift));
+}
+
+void test_truncated_multiplication()
+{
+    std::cout << "\n--- Testing Truncated Multiplication (mul_low / mul_high) ---\n";
+
+    OmniInt a("123456789012345678901234567890");
+    OmniInt b("-987654321098765432109876543210");
+    std::string product = (a * b).abs().toString();
+
+    test_case("mul_low small", mul_low(a, b, 10) == -OmniInt(product.substr(product.size() - 10)));
+    test_case("mul_high small", mul_high(a, b, 10) == -expected_high_part(a, b, 10));
+    test_case("mul_low n >= digits", mul_low(a, b, 100) == a * b);
+    test_case("mul_high n >= digits", mul_high(a, b, 60) == a * b);
+    test_case("mul_low / mul_high with zero", mul_low(a, 0, 5) == 0 && mul_high(0, b, 5) == 0 && mul_low(a, b, 0) == 0);
+
+    // 超过 Karatsuba 阈值；全 9 的乘数会让低位的进位影响高位 (触发退回完整乘法)
+    OmniInt big_a(std::string(700, '9')), big_b(std::string(650, '9'));
+    OmniInt big_c = OmniInt(std::string(500, '3')) * OmniInt("12345678987654321");
+    std::string big = (big_a * big_c).toString();
+    test_case("mul_low large", mul_low(big_a, big_c, 400) == OmniInt(big.substr(big.size() - 400)));
+    test_case("mul_high large", mul_high(big_a, big_c, 400) == expected_high_part(big_a, big_c, 400));
+    test_case("mul_high all nines", mul_high(big_a, big_b, 300) == expected_high_part(big_a, big_b, 300));
+}
+
+void test_transform_multiplication()
+{
+    std::cout << "\n--- Testing Transform Multiplication (FFT / NTT) ---\n";
+
+    // (10^k - 1)(10^j - 1) = 10^(k+j) - 10^k - 10^j + 1
+    OmniInt nines(std::string(5000, '9')), shorter(std::string(3001, '9'));
+    std::string expected = std::string(3000, '9') + "8" + std::string(1999, '9') + std::string(3000, '0') + "1";
+    test_case("transform multiply (10^k - 1)(10^j - 1)", (nines * shorter).toString() == expected);
+    test_case("transform multiply (sign)", (-nines) * shorter == -(nines * shorter) && (-nines) * (-shorter) == nines * shorter);
+
+    // 长度悬殊的乘数
+    OmniInt long_nines(std::string(20000, '9'));
+    OmniInt factor = OmniInt(std::string(400, '7')) + 12345;
+    OmniInt shifted(factor.toString() + std::string(20000, '0'));
+    test_case("transform multiply (unbalanced operands)", long_nines * factor == shifted - factor);
+
+    // 与按 Karatsuba 阈值以下的块拼出的乘积比较
+    OmniInt a = OmniInt(std::string(700, '3')) * OmniInt("98765432123456789") + 1;
+    OmniInt b = OmniInt(std::string(650, '8')) * OmniInt("-1234567890123") - 7;
+    OmniInt b_low(b.abs().toString().substr(b.digitCount() - 100));
+    OmniInt b_high(b.abs().toString().substr(0, b.digitCount() - 100));
+    OmniInt pieces = a * b_high;
+    pieces = OmniInt(pieces.toString() + std::string(100, '0')) + a * b_low;
+    test_case("transform multiply vs split product", a * b == -pieces);
+
+    test_case("mul_low / mul_high above transform threshold",
+              mul_low(a, b, 500) == -OmniInt((a * b).abs().toString().substr((a * b).digitCount() - 500)) &&
+                  mul_high(a, b, 500) == -expected_high_part(a, b, 500));
+
+#ifndef OMNIINT_COMPILED_LIB
+    // FFT 在以上规模都可用，关闭 FFT 后同样的乘积由 NTT 计算
+    {
+        threshold_override no_fft(g_fft_threshold, std::numeric_limits<size_t>::max());
+        test_case("NTT (10^k - 1)(10^j - 1)", (nines * shorter).toString() == expected);
+        test_case("NTT (sign)", (-nines) * shorter == -(nines * shorter) && (-nines) * (-shorter) == nines * shorter);
+        test_case("NTT (chunked unbalanced operands)", long_nines * factor == shifted - factor);
+        test_case("NTT vs FFT product", a * b == -pieces);
+    }
+
+    // SSA 只在极长的乘数上被自动选用：调低阈值并关闭优先于它的 FFT，与 Karatsuba / NTT 的结果比较
+    {
+        const size_t none = std::numeric_limits<size_t>::max();
+        OmniInt karatsuba_product, karatsuba_square;
+        {
+            threshold_override no_ntt(g_ntt_threshold, none), no_fft(g_fft_threshold, none);
+            karatsuba_product = a * b;
+            karatsuba_square = a * a;
+        }
+        OmniInt ntt_product;
+        {
+            threshold_override no_fft(g_fft_threshold, none);
+            ntt_product = a * b;
+        }
+
+#ifdef OMNIINT_STATS
+        const unsigned long long ssa_calls = OmniInt::stats()[OmniIntAlgorithm::MulSsa].calls;
+#endif
+        threshold_override no_fft(g_fft_threshold, none), ssa(g_ssa_threshold, 500);
+        test_case("SSA (10^k - 1)(10^j - 1)", (nines * shorter).toString() == expected);
+        test_case("SSA square of all nines", (shorter * shorter).toString() == std::string(3000, '9') + "8" +
+                                                                                     std::string(3000, '0') + "1");
+        test_case("SSA vs Karatsuba and NTT", a * b == karatsuba_product && a * b == ntt_product && a * a == karatsuba_square);
+#ifdef OMNIINT_STATS
+        test_case("SSA kernel used", OmniInt::stats()[OmniIntAlgorithm::MulSsa].calls >= ssa_calls + 4);
+#endif
+    }
+#endif
+}
+
+void test_prepared_multiplier()
+{
+    std::cout << "\n--- Testing OmniIntPreparedMultiplier ---\n";
+
+    OmniInt x = OmniInt(std::string(1000, '4')) * OmniInt("-31415926535897932384626");
+    OmniIntPreparedMultiplier prepared(x);
+    bool same = true;
+    for (size_t digits : {1, 50, 500, 1023, 1024, 3000, 9000})
+    {
+        OmniInt y = OmniInt(std::string(digits, '6')) + OmniInt(static_cast<long long>(digits));
+        same = same && prepared.mul(y) == x * y && prepared.mul(-y) == -(x * y);
+    }
+    test_case("prepared mul matches operator*", same);
+    test_case("prepared mul reuses cached transform", prepared.mul(OmniInt(std::string(1200, '9'))) ==
+                                                          x * OmniInt(std::string(1200, '9')));
+    test_case("prepared mul by zero", prepared.mul(0) == 0 && OmniIntPreparedMultiplier(0).mul(x) == 0);
+
+    prepared.clear_cache();
+    test_case("prepared mul after clear_cache", prepared.mul(x) == x * x && prepared.value() == x);
+
+#ifndef OMNIINT_COMPILED_LIB
+    // 调低 SSA 阈值后 operator* 改用 SSA，mul() 也应随之改用 SSA 而不是缓存的 NTT 变换
+    {
+        const size_t none = std::numeric_limits<size_t>::max();
+        threshold_override no_fft(g_fft_threshold, none), ssa(g_ssa_threshold, 500);
+#ifdef OMNIINT_STATS
+        const unsigned long long ssa_calls = OmniInt::stats()[OmniIntAlgorithm::MulSsa].calls;
+        const unsigned long long ntt_calls = OmniInt::stats()[OmniIntAlgorithm::MulNtt].calls;
+#endif
+        OmniInt y = OmniInt(std::string(3000, '6')) + 7;
+        test_case("prepared mul follows the SSA threshold", prepared.mul(y) == x * y && prepared.mul(-y) == -(x * y));
+#ifdef OMNIINT_STATS
+        test_case("prepared mul uses SSA above its threshold",
+                  OmniInt::stats()[OmniIntAlgorithm::MulSsa].calls >= ssa_calls + 4 &&
+                      OmniInt::stats()[OmniIntAlgorithm::MulNtt].calls == ntt_calls);
+#endif
+    }
+#endif
+}
+
+void test_sum()
+{
+    std::cout << "\n--- Testing OmniIntSum (deferred carries) ---\n";
+
+    OmniIntSum sum;
+    OmniInt expected;
+    for (int i = 0; i < 1000; ++i)
+    {
+        OmniInt term = OmniInt("99999999999999999999") * (i % 7 == 0 ? -i : i);
+        sum += term;
+        expected += term;
+    }
+    test_case("OmniIntSum matches repeated +=", sum.value() == expected);
+    test_case("OmniIntSum comparison", sum == expected && sum < expected + 1 && sum > expected - 1);
+    test_case("OmniIntSum multiplication", sum * OmniInt(3) == expected * 3);
+
+    sum -= expected;
+    test_case("OmniIntSum -= back to zero", sum.value() == 0);
+
+    // 反复合并自身，使数位上限超过 32 位并触发进位传播
+    OmniIntSum doubling(OmniInt(1));
+    for (int i = 0; i < 40; ++i)
+    {
+        doubling += doubling;
+    }
+    test_case("OmniIntSum lane overflow normalization", doubling.value() == OmniInt("1099511627776"));
+}
+
+void test_accumulator()
+{
+    std::cout << "\n--- Testing OmniIntAccumulator / parallel_sum ---\n";
+
+    std::vector<OmniInt> values;
+    OmniInt expected;
+    for (int i = 0; i < 5000; ++i)
+    {
+        OmniInt v = OmniInt("123456789012345678901234567890") * (i % 3 == 0 ? -i : i);
+        values.push_back(v);
+        expected += v;
+    }
+
+    OmniIntAccumulator acc(3);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&acc, &values, t]()
+                             {
+                                 for (size_t i = t; i < values.size(); i += 4)
+                                     acc.add(values[i]);
+                             });
+    }
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+    test_case("OmniIntAccumulator concurrent add", acc.result() == expected);
+
+    acc.subtract(expected);
+    test_case("OmniIntAccumulator subtract", acc.result() == 0);
+    acc.add(OmniInt(5));
+    acc.clear();
+    test_case("OmniIntAccumulator clear", acc.result() == 0);
+
+    test_case("parallel_sum (4 threads)", parallel_sum(values, 4, 100) == expected);
+    test_case("parallel_sum (iterators, 1 thread)", parallel_sum(values.begin(), values.end(), 1) == expected);
+    test_case("parallel_sum (uneven split)", parallel_sum(values.begin(), values.begin() + 1001, 7, 1) ==
+                                                 parallel_sum(values.begin(), values.begin() + 1001, 1));
+    test_case("parallel_sum (empty range)", parallel_sum(std::vector<OmniInt>()) == 0);
+}
+
+void test_async()
+{
+    std::cout << "\n--- Testing Async Operations / Cancellation ---\n";
+
+    OmniInt a(std::string(300, '7'));
+    OmniInt b(std::string(200, '3'));
+    const OmniInt expected_product = a * b;
+
+    OmniIntFuture<OmniInt> product = async_multiply(a, b);
+    OmniIntFuture<OmniInt> quotient = async_divide(a, b);
+    OmniIntFuture<OmniInt> root = async_sqrt(a);
+    OmniIntFuture<std::string> text = async_to_string(a);
+    test_case("async_multiply", product.get() == expected_product);
+    test_case("async_multiply progress reaches 1", product.progress() == 1.0);
+    test_case("async_divide", quotient.get() == a / b);
+    test_case("async_sqrt", root.get() == sqrt(a));
+    test_case("async_to_string", text.get() == a.toString());
+
+    OmniIntFuture<OmniInt> by_zero = async_divide(a, OmniInt(0));
+    try
+    {
+        by_zero.get();
+        test_case("async_divide propagates division by zero", false);
+    }
+    catch (const std::runtime_error &)
+    {
+        test_case("async_divide propagates division by zero", true);
+    }
+
+    OmniIntCancelToken token;
+    token.cancel();
+    OmniIntFuture<OmniInt> cancelled = async_multiply(a, b, token);
+    try
+    {
+        cancelled.get();
+        test_case("async_multiply cancelled before start", false);
+    }
+    catch (const OmniIntCancelled &)
+    {
+        test_case("async_multiply cancelled before start", true);
+    }
+
+    // 在当前线程中直接设置上下文，检查核心循环中的取消点与进度报告
+    std::atomic<bool> flag(false);
+    std::atomic<double> progress(0.0);
+    {
+        omniint_detail::operation_context_guard guard(&flag, &progress);
+        OmniInt big = a * b;
+        test_case("progress after multiply", progress.load() == 1.0 && big == expected_product);
+        progress = 0.0;
+        OmniInt q = (big + 1) / a;
+        test_case("progress after divide", progress.load() == 1.0 && q == b);
+
+        flag = true;
+        try
+        {
+            OmniInt r = a * b;
+            test_case("multiply polls the cancel flag", false);
+        }
+        catch (const OmniIntCancelled &)
+        {
+            test_case("multiply polls the cancel flag", true);
+        }
+        try
+        {
+            OmniInt r = a / b;
+            test_case("divide polls the cancel flag", false);
+        }
+        catch (const OmniIntCancelled &)
+        {
+            test_case("divide polls the cancel flag", true);
+        }
+    }
+    test_case("context cleared after guard", a * b == expected_product);
+}
+
+void test_digit_reader()
+{
+    std::cout << "\n--- Testing Streaming Digit Output ---\n";
+
+    OmniInt n = -(OmniInt(std::string(1000, '9')) * OmniInt("123456789"));
+    const std::string expected = n.toString();
+
+    OmniIntDigitReader reader(n, 7);
+    std::string joined, chunk;
+    bool bounded = true;
+    while (reader.next(chunk))
+    {
+        bounded = bounded && chunk.size() <= 7;
+        joined += chunk;
+    }
+    test_case("digit reader chunks join to toString()", joined == expected && bounded);
+    test_case("digit reader done", reader.done() && !reader.next(chunk));
+
+    OmniIntDigitReader iterated(n, 100);
+    joined.clear();
+    for (const std::string &piece : iterated)
+        joined += piece;
+    test_case("digit reader range-for", joined == expected);
+
+    const OmniInt zero_value;
+    OmniIntDigitReader zero(zero_value, 1);
+    test_case("digit reader on zero", zero.next(chunk) && chunk == "0" && !zero.next(chunk));
+
+    std::stringstream ss;
+    write_digits(ss, n, 64);
+    test_case("write_digits", ss.str() == expected);
+
+    std::stringstream chunked, padded;
+    chunked << OmniInt(std::string(10000, '8'));
+    padded << std::setw(6) << OmniInt(-42);
+    test_case("operator<< streams large values", chunked.str() == std::string(10000, '8'));
+    test_case("operator<< honours setw", padded.str() == "   -42");
+}
+
+static void write_text_file(const std::string &path, const std::string &content)
+{
+    std::ofstream out(path.c_str(), std::ios::binary);
+    out << content;
+}
+
+static std::string read_text_file(const std::string &path)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+void test_out_of_core()
+{
+    std::cout << "\n--- Testing Out-of-Core Multiplication ---\n";
+
+    const std::string a_path = "omniint_test_a.txt", b_path = "omniint_test_b.txt", out_path = "omniint_test_out.txt";
+    OmniInt a = OmniInt(std::string(1234, '9')) * OmniInt("98765432123456789");
+    OmniInt b = -OmniInt(std::string(567, '3'));
+
+    // 块大小远小于操作数，覆盖多块累加与进位
+    OmniIntOutOfCoreOptions options;
+    options.block_digits = 100;
+
+    write_text_file(a_path, a.toString() + "\n");
+    write_text_file(b_path, b.toString());
+    size_t digits = multiply_files(a_path, b_path, out_path, options);
+    test_case("multiply_files (multi-block)", read_text_file(out_path) == (a * b).toString() + "\n");
+    test_case("multiply_files digit count", digits == (a * b).digitCount());
+
+    // 内存预算只够每次读入少量元素，正变换与逆变换各需多遍
+    options.memory_budget = 2048;
+    multiply_files(a_path, b_path, out_path, options);
+    test_case("multiply_files (multi-pass transform)", read_text_file(out_path) == (a * b).toString() + "\n");
+
+    const OmniInt nines(std::string(3001, '9'));
+    write_text_file(b_path, nines.toString());
+    options.block_digits = 50;
+    multiply_files(b_path, b_path, out_path, options);
+    test_case("multiply_files (square of all nines)", read_text_file(out_path) == (nines * nines).toString() + "\n");
+
+    write_text_file(b_path, b.toString());
+    options = OmniIntOutOfCoreOptions(); // 根据内存预算选择块大小
+    multiply_files(b_path, a_path, out_path, options);
+    test_case("multiply_files (single block)", read_text_file(out_path) == (a * b).toString() + "\n");
+
+    write_text_file(a_path, "-000");
+    multiply_files(a_path, b_path, out_path, options);
+    test_case("multiply_files (zero, leading zeros)", read_text_file(out_path) == "0\n");
+
+    write_text_file(a_path, "12x4");
+    try
+    {
+        multiply_files(a_path, b_path, out_path, options);
+        test_case("multiply_files rejects invalid input", false);
+    }
+    catch (const std::invalid_argument &)
+    {
+        test_case("multiply_files rejects invalid input", true);
+    }
+
+    std::remove(a_path.c_str());
+    std::remove(b_path.c_str());
+    std::remove(out_path.c_str());
+}
+
+void test_checkpoint()
+{
+    std::cout << "\n--- Testing Binary Format / Checkpoints ---\n";
+
+    const OmniInt values[] = {OmniInt(0), OmniInt(7), OmniInt(-12345), OmniInt(std::string(1001, '9'))};
+    bool round_trip = true;
+    for (const OmniInt &v : values)
+    {
+        std::stringstream ss;
+        write_binary(ss, v);
+        round_trip = round_trip && read_binary(ss) == v;
+    }
+    test_case("binary format round trip", round_trip);
+
+    std::stringstream corrupted;
+    write_binary(corrupted, OmniInt(123456));
+    std::string bytes = corrupted.str();
+    bytes[15] ^= 0x01;
+    std::stringstream damaged(bytes);
+    try
+    {
+        read_binary(damaged);
+        test_case("binary format detects corruption", false);
+    }
+    catch (const std::runtime_error &)
+    {
+        test_case("binary format detects corruption", true);
+    }
+
+    const std::string path = "omniint_test.ckpt";
+    OmniIntCheckpoint saved;
+    saved.set("x", OmniInt("-98765432109876543210"));
+    saved.set_counter("step", 42);
+    saved.save(path);
+    OmniIntCheckpoint loaded;
+    test_case("checkpoint save/load", loaded.load(path) && loaded.get("x") == saved.get("x") &&
+                                          loaded.counter("step") == 42 && !loaded.has("y"));
+    std::remove(path.c_str());
+    test_case("checkpoint load of missing file", !loaded.load(path) && !loaded.has("x"));
+
+    // 输出目录不存在时，乘法在最后写入输出文件时失败，检查点停留在最后一步的进位传播中
+    const std::string a_path = "omniint_test_a.txt", b_path = "omniint_test_b.txt", out_path = "omniint_test_out.txt";
+    const std::string missing_out = "omniint_missing_dir/omniint_test_out.txt";
+    const OmniInt a("918273645546372819987654321012345678901234567"), b("-5647382910019283746556473829101");
+    const OmniInt other("123456789012345678901234567890123456789012345"); // 与 a 位数相同
+    const size_t k = 10;
+    write_text_file(a_path, a.toString());
+    write_text_file(b_path, b.toString());
+
+    OmniIntOutOfCoreOptions options;
+    options.block_digits = k;
+    options.memory_budget = 100; // 每遍只读入两个元素，逆变换分为多遍、多组
+    options.scratch_dir = ".";   // 两个输出路径使用同一组临时文件
+    options.checkpoint_path = "omniint_test_multiply.ckpt";
+    options.checkpoint_seconds = 0;
+    OmniIntCheckpoint state;
+    auto interrupted_run = [&]()
+    {
+        write_text_file(a_path, a.toString());
+        try
+        {
+            multiply_files(a_path, b_path, missing_out, options);
+            return false;
+        }
+        catch (const std::runtime_error &)
+        {
+            return state.load(options.checkpoint_path);
+        }
+    };
+
+    // 续算不再读取已经处理过的输入：换成位数相同的另一个数后结果仍是原来的乘积，说明使用了检查点
+    bool interrupted = interrupted_run();
+    test_case("multiply_files keeps checkpoint when interrupted", interrupted);
+    write_text_file(a_path, other.toString());
+    multiply_files(a_path, b_path, out_path, options);
+    test_case("multiply_files resumes from checkpoint", read_text_file(out_path) == (a * b).toString() + "\n");
+    test_case("checkpoint removed after completion", !state.load(options.checkpoint_path));
+
+    // 进位被故意加一时，结果相应地多出 10^(jk)
+    interrupted = interrupted_run();
+    const size_t j = static_cast<size_t>(state.counter("next_unit"));
+    state.set("carry", state.get("carry") + 1);
+    state.save(options.checkpoint_path);
+    multiply_files(a_path, b_path, out_path, options);
+    const OmniInt expected = a * b - OmniInt("1" + std::string(j * k, '0'));
+    test_case("multiply_files uses checkpointed carry", interrupted && read_text_file(out_path) == expected.toString() + "\n");
+
+    // 回退到逆变换的最后一遍 (它读取的文件之后没有再被写入)，从中间的分组继续
+    interrupted = interrupted_run();
+    state.set_counter("step", state.counter("step") - 1);
+    state.set_counter("next_unit", 1);
+    state.set("carry", OmniInt(0));
+    state.save(options.checkpoint_path);
+    write_text_file(a_path, other.toString());
+    multiply_files(a_path, b_path, out_path, options);
+    test_case("multiply_files resumes inside the transform",
+              interrupted && read_text_file(out_path) == (a * b).toString() + "\n");
+
+    // 参数与检查点不符时重新开始，读取新的输入
+    interrupted = interrupted_run();
+    options.memory_budget = 256;
+    write_text_file(a_path, other.toString());
+    multiply_files(a_path, b_path, out_path, options);
+    test_case("multiply_files restarts on mismatched checkpoint",
+              interrupted && read_text_file(out_path) == (other * b).toString() + "\n");
+
+    std::remove(a_path.c_str());
+    std::remove(b_path.c_str());
+    std::remove(out_path.c_str());
+}
+
+// 逐项相乘的参考实现
+OmniPoly naive_poly_product(const OmniPoly &a, const OmniPoly &b)
+{
+    std::vector<OmniInt> c(a.coefficients().size() + b.coefficients().size());
+    for (size_t i = 0; i < a.coefficients().size(); ++i)
+        for (size_t j = 0; j < b.coefficients().size(); ++j)
+            c[i + j] += a.coefficients()[i] * b.coefficients()[j];
+    return OmniPoly(c);
+}
+
+void test_poly()
+{
+    std::cout << "\n--- Testing Polynomials (OmniPoly) ---\n";
+
+    OmniPoly p{-1, 0, 3};  // 3x^2 - 1
+    OmniPoly q{2, 1};      // x + 2
+    test_case("poly degree and toString", p.degree() == 2 && p.toString() == "3*x^2 - 1" && OmniPoly().degree() == -1);
+    test_case("poly add/sub trims", (p + q).toString() == "3*x^2 + x + 1" && (p - p).is_zero());
+    test_case("poly multiply", (p * q).toString() == "3*x^3 + 6*x^2 - x - 2");
+    test_case("poly multiply by scalar", (q * 3).toString() == "3*x + 6" && (p * OmniPoly()).is_zero());
+    test_case("poly evaluate (Horner)", p(OmniInt(5)) == 74 && q.evaluate(OmniInt(-2)) == 0);
+
+    // 大系数、正负混合：进位与借位会跨越相邻系数的边界
+    OmniPoly a, b;
+    for (size_t i = 0; i < 40; ++i)
+    {
+        OmniInt c = OmniInt(std::string(30 + i % 7, '9')) * (i % 3 == 0 ? -1 : 1) + OmniInt(static_cast<long long>(i));
+        a.set(i, c);
+        b.set(i, i % 5 == 0 ? OmniInt(0) : -c + 7);
+    }
+    b.set(45, OmniInt(std::string(60, '9')));
+    test_case("poly Kronecker multiply matches naive", a * b == naive_poly_product(a, b));
+    test_case("poly square matches naive", a * a == naive_poly_product(a, a));
+#ifdef OMNIINT_TRACK_MEMORY
+    // a * a 先复制左操作数，系数相同时仍应只打包一次：比同样大小的两个不同多项式相乘少分配一个打包后的整数
+    {
+        OmniPoly near = a;
+        near.set(0, a.coefficients()[0] + 1);
+        OmniInt::reset_memory_usage();
+        OmniPoly square = a * a;
+        const unsigned long long square_bytes = OmniInt::memory_usage().storage.bytes_allocated;
+        OmniInt::reset_memory_usage();
+        OmniPoly product = a * near;
+        const unsigned long long product_bytes = OmniInt::memory_usage().storage.bytes_allocated;
+        // 打包宽度至少是两个最大系数的位数之和
+        const size_t packed_digits = a.coefficients().size() * 2 * 36;
+        test_case("poly square packs the operand once", square_bytes + packed_digits * sizeof(int) <= product_bytes);
+    }
+#endif
+    test_case("poly product evaluates consistently",
+              (a * b).evaluate(OmniInt(12345)) == a.evaluate(OmniInt(12345)) * b.evaluate(OmniInt(12345)));
+
+    // 除法：首项为 ±1 时总能整除；一般情况只在整除时成功
+    OmniPoly monic{5, -3, 0, 1};
+    OmniPoly quotient, remainder;
+    divmod(a, monic, quotient, remainder);
+    test_case("poly divmod by monic", quotient * monic + remainder == a && remainder.degree() < monic.degree());
+    OmniPoly d{7, 0, -4};
+    test_case("poly exact division", (a * d) / d == a && ((a * d) % d).is_zero());
+    try
+    {
+        OmniPoly r = q / OmniPoly{1, 2};
+        test_case("poly inexact division throws", false);
+    }
+    catch (const std::domain_error &)
+    {
+        test_case("poly inexact division throws", true);
+    }
+    try
+    {
+        OmniPoly r = p / OmniPoly();
+        test_case("poly division by zero throws", false);
+    }
+    catch (const std::runtime_error &)
+    {
+        test_case("poly division by zero throws", true);
+    }
+}
+
+// 逐个元素相乘的参考实现
+OmniMatrix naive_matrix_product(const OmniMatrix &a, const OmniMatrix &b)
+{
+    OmniMatrix c(a.rows(), b.cols());
+    for (size_t i = 0; i < a.rows(); ++i)
+        for (size_t j = 0; j < b.cols(); ++j)
+            for (size_t k = 0; k < a.cols(); ++k)
+                c(i, j) += a(i, k) * b(k, j);
+    return c;
+}
+
+// 元素位数在 [1, max_digits] 之间、正负交替的确定性测试矩阵
+OmniMatrix test_matrix(size_t rows, size_t cols, size_t max_digits, unsigned seed)
+{
+    OmniMatrix m(rows, cols);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        for (size_t j = 0; j < cols; ++j)
+        {
+            seed = seed * 1103515245u + 12345u;
+            std::string s(1 + seed % max_digits, '0');
+            for (size_t d = 0; d < s.size(); ++d)
+                s[d] = static_cast<char>('0' + (seed >> (d % 16)) % 10);
+            m(i, j) = OmniInt(s) * ((i + j) % 2 == 0 ? 1 : -1);
+        }
+    }
+    return m;
+}
+
+void test_matrix()
+{
+    std::cout << "\n--- Testing Matrices (OmniMatrix) ---\n";
+
+    OmniMatrix a{{1, 2}, {3, 4}};
+    OmniMatrix b{{0, 1}, {-1, 5}};
+    test_case("matrix multiply small", a * b == OmniMatrix{{-2, 11}, {-4, 23}});
+    test_case("matrix identity", a * OmniMatrix::identity(2) == a && a.transpose() == OmniMatrix{{1, 3}, {2, 4}});
+    test_case("matrix toString", a.toString() == "[[1, 2], [3, 4]]");
+
+    // 多模乘法 (元素较短)、Strassen 分块 (元素较长，奇数维需要补零) 与参考实现比较
+    OmniMatrix x = test_matrix(13, 11, 40, 1), y = test_matrix(11, 9, 40, 2);
+    test_case("matrix multimodular multiply matches naive", x * y == naive_matrix_product(x, y));
+    OmniMatrix u = test_matrix(9, 7, 600, 3), v = test_matrix(7, 5, 600, 4);
+    test_case("matrix strassen multiply matches naive", u * v == naive_matrix_product(u, v));
+
+    test_case("matrix determinant", OmniMatrix{{2, -3, 1}, {2, 0, -1}, {1, 4, 5}}.determinant() == 49);
+    test_case("matrix determinant needs row swap", OmniMatrix{{0, 1}, {1, 0}}.determinant() == -1);
+    test_case("matrix singular determinant", OmniMatrix{{1, 2}, {2, 4}}.determinant() == 0);
+    OmniMatrix s = test_matrix(6, 6, 30, 5), t = test_matrix(6, 6, 30, 6);
+    test_case("matrix determinant is multiplicative", (s * t).determinant() == s.determinant() * t.determinant());
+
+    OmniInt denominator;
+    OmniMatrix rhs = test_matrix(6, 2, 20, 7);
+    OmniMatrix solution = solve(s, rhs, denominator);
+    test_case("matrix solve", s * solution == rhs * denominator && denominator == s.determinant().abs());
+    try
+    {
+        solve(OmniMatrix{{1, 2}, {2, 4}}, OmniMatrix{{1}, {1}}, denominator);
+        test_case("matrix solve singular throws", false);
+    }
+    catch (const std::domain_error &)
+    {
+        test_case("matrix solve singular throws", true);
+    }
+    try
+    {
+        OmniMatrix bad = a * OmniMatrix(3, 1);
+        test_case("matrix dimension mismatch throws", false);
+    }
+    catch (const std::invalid_argument &)
+    {
+        test_case("matrix dimension mismatch throws", true);
+    }
+}
+
+// 逐个商做除法的参考实现
+std::vector<OmniInt> naive_continued_fraction(OmniInt p, OmniInt q)
+{
+    std::vector<OmniInt> quotients;
+    OmniInt a = p / q;
+    if (p - a * q < 0)
+        --a;
+    quotients.push_back(a);
+    p -= a * q;
+    while (!p.is_zero())
+    {
+        std::swap(p, q);
+        quotients.push_back(p / q);
+        p %= q;
+    }
+    return quotients;
+}
+
+// Python Fraction.limit_denominator 的算法，q > 0
+std::pair<OmniInt, OmniInt> naive_best_approximation(const OmniInt &p, const OmniInt &q, const OmniInt &bound)
+{
+    std::vector<OmniInt> a = naive_continued_fraction(p, q);
+    OmniInt p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        OmniInt q2 = q0 + a[i] * q1;
+        if (q2 > bound)
+        {
+            OmniInt t = (bound - q0) / q1, sp = p0 + t * p1, sq = q0 + t * q1;
+            if ((p1 * q - p * q1).abs() * sq <= (sp * q - p * sq).abs() * q1)
+                return std::make_pair(p1, q1);
+            return std::make_pair(sp, sq);
+        }
+        OmniInt p2 = p0 + a[i] * p1;
+        p0 = p1, q0 = q1, p1 = p2, q1 = q2;
+    }
+    return std::make_pair(p1, q1);
+}
+
+OmniInt test_number(size_t digits, unsigned seed)
+{
+    std::string s(digits, '0');
+    for (size_t d = 0; d < digits; ++d)
+    {
+        seed = seed * 1103515245u + 12345u;
+        s[d] = static_cast<char>('0' + (seed >> 16) % 10);
+    }
+    s[0] = '7';
+    return OmniInt(s);
+}
+
+void test_continued_fraction()
+{
+    std::cout << "\n--- Testing Continued Fractions ---\n";
+
+    const std::vector<OmniInt> expected{4, 2, 6, 7};
+    test_case("continued fraction 415/93", continued_fraction(415, 93) == expected);
+    const std::vector<OmniInt> negative{-5, 1, 1, 6, 7};
+    test_case("continued fraction of negative", continued_fraction(-415, 93) == negative &&
+                                                    continued_fraction(415, -93) == negative);
+    test_case("continued fraction of integer", continued_fraction(10, 5) == std::vector<OmniInt>{2} &&
+                                                   continued_fraction(0, 7) == std::vector<OmniInt>{0});
+
+    // 长的随机分数与相邻的斐波那契数 (部分商全为 1，截断最容易失效)
+    OmniInt p = test_number(320, 1), q = test_number(290, 2);
+    std::vector<OmniInt> cf = continued_fraction(p, q);
+    test_case("continued fraction matches division", cf == naive_continued_fraction(p, q));
+    OmniInt h0 = 1, h1 = 0, k0 = 0, k1 = 1; // 由部分商重建 p / q
+    for (size_t i = 0; i < cf.size(); ++i)
+    {
+        OmniInt h = cf[i] * h0 + h1, k = cf[i] * k0 + k1;
+        h1 = h0, k1 = k0, h0 = h, k0 = k;
+    }
+    OmniInt g = gcd(p, q);
+    test_case("continued fraction reconstructs value", h0 == p / g && k0 == q / g);
+    OmniInt f0 = 1, f1 = 1;
+    for (int i = 0; i < 1000; ++i)
+    {
+        OmniInt f = f0 + f1;
+        f0 = f1, f1 = f;
+    }
+    std::vector<OmniInt> ones = continued_fraction(f1, f0);
+    test_case("continued fraction of Fibonacci ratio", ones == naive_continued_fraction(f1, f0) && ones.size() == 1000);
+
+    const OmniInt pi("3141592653589793"), scale("1000000000000000");
+    test_case("best approximation of pi", best_rational_approximation(pi, scale, 1000) == std::make_pair(OmniInt(355), OmniInt(113)) &&
+                                              best_rational_approximation(pi, scale, 100) == std::make_pair(OmniInt(311), OmniInt(99)) &&
+                                              best_rational_approximation(-pi, scale, 1000) == std::make_pair(OmniInt(-355), OmniInt(113)));
+    test_case("best approximation returns exact value", best_rational_approximation(6, -4, 10) == std::make_pair(OmniInt(-3), OmniInt(2)));
+    OmniInt bound = test_number(40, 3);
+    test_case("best approximation of long fraction", best_rational_approximation(p, q, bound) == naive_best_approximation(p, q, bound) &&
+                                                         best_rational_approximation(-q, p, bound) == naive_best_approximation(-q, p, bound));
+    try
+    {
+        continued_fraction(1, 0);
+        test_case("continued fraction of x/0 throws", false);
+    }
+    catch (const std::runtime_error &)
+    {
+        test_case("continued fraction of x/0 throws", true);
+    }
+    try
+    {
+        best_rational_approximation(1, 3, 0);
+        test_case("best approximation with bound 0 throws", false);
+    }
+    catch (const std::invalid_argument &)
+    {
+        test_case("best approximation with bound 0 throws", true);
+    }
+}
+
+void test_random()
+{
+    std::cout << "\n--- Testing Random Numbers (OmniIntRandom) ---\n";
+
+    OmniIntRandomEngine a(42), b(42);
+    test_case("random engine is deterministic", random_digits(100, a) == random_digits(100, b) && a() == b());
+
+    // 每个值都应出现，且次数接近期望
+    OmniIntRandomEngine rng(7);
+    int counts[10] = {0};
+    for (int i = 0; i < 10000; ++i)
+        ++counts[random_below(10, rng).toLongLong()];
+    test_case("random_below(10) is roughly uniform", *std::min_element(counts, counts + 10) > 850 &&
+                                                          *std::max_element(counts, counts + 10) < 1150);
+
+    // bound 的高 18 位之后只差 1：几乎总要比较低位
+    const OmniInt bound("100000000000000000000000000001"), limit("1000000000000000000000000000000");
+    bool below_ok = true, saw_large = false;
+    for (int i = 0; i < 200; ++i)
+    {
+        OmniInt x = random_below(bound, rng);
+        below_ok = below_ok && x >= 0 && x < bound;
+        saw_large = saw_large || x.digitCount() == 29;
+    }
+    test_case("random_below stays below bound", below_ok && saw_large);
+
+    bool bits_ok = true, top_bit = false;
+    const OmniInt two_100("1267650600228229401496703205376");
+    for (int i = 0; i < 200; ++i)
+    {
+        OmniInt x = random_bits(100, rng);
+        bits_ok = bits_ok && x >= 0 && x < two_100;
+        top_bit = top_bit || x + x >= two_100;
+    }
+    test_case("random_bits(100) is below 2^100", bits_ok && top_bit && random_bits(0, rng) == 0);
+
+    bool seen[11] = {false}, range_ok = true;
+    for (int i = 0; i < 500; ++i)
+    {
+        long long x = random_range(-5, 5, rng).toLongLong();
+        range_ok = range_ok && x >= -5 && x <= 5;
+        if (range_ok)
+            seen[x + 5] = true;
+    }
+    test_case("random_range covers [lo, hi]", range_ok && std::count(seen, seen + 11, true) == 11);
+
+    std::mt19937 mt(1);
+    OmniInt d = random_digits(50, mt);
+    test_case("random functions accept std engines", d >= 0 && d < limit * limit && random_below(OmniInt(limit), mt) < limit);
+    test_case("default engine", random_range(3, 3) == 3 && random_digits(20) < OmniInt("100000000000000000000"));
+
+    try
+    {
+        random_below(0, rng);
+        test_case("random_below(0) throws", false);
+    }
+    catch (const std::invalid_argument &)
+    {
+        test_case("random_below(0) throws", true);
+    }
+    try
+    {
+        random_range(5, 4);
+        test_case("random_range with lo > hi throws", false);
+    }
+    catch (const std::invalid_argument &)
+    {
+        test_case("random_range with lo > hi throws", true);
+    }
+}
+
+#ifdef OMNIINT_STATS
+void test_stats()
+{
+    std::cout << "\n--- Testing Statistics (OMNIINT_STATS) ---\n";
+
+    OmniInt::reset_stats();
+    OmniInt a(std::string(200, '7'));
+    OmniInt b(std::string(100, '3'));
+    OmniInt small_product = OmniInt(12) * OmniInt(34);
+    OmniInt big_product = a * b;
+    OmniInt q = a / b;
+    OmniInt c(std::string(300, '5'));
+    OmniInt fft_product = c * c;
+    std::ostringstream streamed;
+    streamed << a;
+    a.toString();
+
+    OmniInt::Stats s = OmniInt::stats();
+    test_case("stats: schoolbook multiply counted", s[OmniIntAlgorithm::MulSchoolbook].calls >= 1);
+    test_case("stats: karatsuba multiply counted", s[OmniIntAlgorithm::MulKaratsuba].calls == 1);
+    test_case("stats: size histogram bucket (200 limbs -> bucket 7)",
+              s[OmniIntAlgorithm::MulKaratsuba].size_histogram[7] == 1);
+    test_case("stats: fft multiply counted", s[OmniIntAlgorithm::MulFft].calls == 1);
+#ifndef OMNIINT_COMPILED_LIB
+    {
+        threshold_override no_fft(g_fft_threshold, std::numeric_limits<size_t>::max());
+        OmniInt ntt_product = c * c;
+    }
+    test_case("stats: ntt multiply counted", OmniInt::stats()[OmniIntAlgorithm::MulNtt].calls == 1);
+#endif
+    test_case("stats: long division counted", s[OmniIntAlgorithm::LongDivision].calls == 1);
+    test_case("stats: allocations counted", s[OmniIntAlgorithm::MulKaratsuba].allocations > 0);
+    test_case("stats: operator<< counted as ToString", s[OmniIntAlgorithm::ToString].calls == 2);
+
+    OmniInt::reset_stats();
+    test_case("stats: reset", OmniInt::stats()[OmniIntAlgorithm::MulKaratsuba].calls == 0);
+}
+#endif
+
+#ifdef OMNIINT_TRACK_MEMORY
+void test_memory_tracking()
+{
+    std::cout << "\n--- Testing Memory Tracking (OMNIINT_TRACK_MEMORY) ---\n";
+
+    const OmniInt::MemoryUsage before = OmniInt::memory_usage();
+    OmniInt::reset_memory_usage();
+    {
+        OmniInt a(std::string(300, '9'));
+        OmniInt b(std::string(120, '7'));
+        OmniInt product = a * b;
+        OmniInt quotient = a / b;
+
+        OmniInt::MemoryUsage during = OmniInt::memory_usage();
+        test_case("memory: storage live bytes grow",
+                  during.storage.live_bytes >= before.storage.live_bytes + 420 * sizeof(int));
+        test_case("memory: scratch allocations recorded", during.scratch.allocations > 0);
+        test_case("memory: scratch released after operations", during.scratch.live_bytes == 0);
+        test_case("memory: scratch peak covers result_val",
+                  during.scratch.peak_live_bytes >= 420 * sizeof(long long));
+        test_case("memory: total = storage + scratch",
+                  during.total.bytes_allocated == during.storage.bytes_allocated + during.scratch.bytes_allocated);
+    }
+    OmniInt::MemoryUsage after = OmniInt::memory_usage();
+    test_case("memory: storage released", after.storage.live_bytes == before.storage.live_bytes);
+
+    // OmniIntSum 的冗余数位同样计入 storage
+    {
+        const OmniInt big(std::string(5000, '9'));
+        const unsigned long long live = OmniInt::memory_usage().storage.live_bytes;
+        OmniIntSum sum;
+        sum += big;
+        test_case("memory: OmniIntSum lanes tracked",
+                  OmniInt::memory_usage().storage.live_bytes >= live + 5000 * sizeof(std::uint32_t));
+    }
+    test_case("memory: peak survives release", after.total.peak_live_bytes > after.total.live_bytes);
+}
+#endif
+
+#ifdef OMNIINT_TRACE
+std::vector<OmniIntTraceRecord> g_trace_records;
+
+void record_trace(const OmniIntTraceRecord &record)
+{
+    g_trace_records.push_back(record);
+}
+
+void test_trace()
+{
+    std::cout << "\n--- Testing Trace Hooks (OMNIINT_TRACE) ---\n";
+
+    OmniInt a("123456789012345678901234567890");
+    OmniInt b("987654321");
+
+    g_trace_records.clear();
+    OmniInt::set_trace_callback(&record_trace);
+    OmniInt product = a * b;
+    OmniInt::set_trace_callback(nullptr);
+
+    test_case("trace: enter and exit recorded", g_trace_records.size() == 2);
+    test_case("trace: multiply enter with operand sizes",
+              g_trace_records.size() == 2 && g_trace_records[0].event == OmniIntTraceEvent::Enter &&
+                  g_trace_records[0].op == OmniIntTraceOp::Multiply &&
+                  g_trace_records[0].size_a == 30 && g_trace_records[0].size_b == 9);
+    test_case("trace: multiply exit", g_trace_records.size() == 2 && g_trace_records[1].event == OmniIntTraceEvent::Exit);
+
+    g_trace_records.clear();
+    OmniInt::set_trace_callback(&record_trace);
+    gcd(a, b);
+    OmniInt::set_trace_callback(nullptr);
+    test_case("trace: gcd wraps nested divisions",
+              !g_trace_records.empty() && g_trace_records.front().op == OmniIntTraceOp::Gcd &&
+                  g_trace_records.back().op == OmniIntTraceOp::Gcd &&
+                  g_trace_records.back().event == OmniIntTraceEvent::Exit);
+
+    g_trace_records.clear();
+    OmniInt::set_trace_callback(&record_trace);
+    std::ostringstream streamed;
+    streamed << a;
+    OmniInt::set_trace_callback(nullptr);
+    test_case("trace: operator<< traced as ToString",
+              g_trace_records.size() == 2 && g_trace_records[0].op == OmniIntTraceOp::ToString &&
+                  g_trace_records[0].size_a == 30 && g_trace_records[1].event == OmniIntTraceEvent::Exit);
+
+    g_trace_records.clear();
+    sqrt(a);
+    test_case("trace: no events after unregistering", g_trace_records.empty());
+}
+#endif
+
 // =========================================================================
 // 主函数
 // =========================================================================
@@ -351,6 +1520,31 @@ int main()
     test_utility_and_streams();
     test_sqrt();
     test_gcd(); // <-- 新增对 gcd 测试的调用
+    test_ilog();
+    test_floating_conversion();
+    test_large_multiplication();
+    test_truncated_multiplication();
+    test_transform_multiplication();
+    test_prepared_multiplier();
+    test_sum();
+    test_accumulator();
+    test_async();
+    test_digit_reader();
+    test_out_of_core();
+    test_checkpoint();
+    test_poly();
+    test_matrix();
+    test_continued_fraction();
+    test_random();
+#ifdef OMNIINT_STATS
+    test_stats();
+#endif
+#ifdef OMNIINT_TRACK_MEMORY
+    test_memory_tracking();
+#endif
+#ifdef OMNIINT_TRACE
+    test_trace();
+#endif
     test_exceptions();
 
     std::cout << "\n----------------------------------------" << std::endl;
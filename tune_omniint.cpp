@@ -0,0 +1,362 @@
+/*
+tune_omniint.cpp
+
+在当前机器上测量各算法之间的分界点，并生成 OmniInt_thresholds.h。
+
+用法:
+    ./tune [输出文件，默认为 OmniInt_thresholds.h]
+
+在使用 OmniInt.h 的程序中定义 OMNIINT_USE_TUNED_THRESHOLDS，即可使用生成的阈值。
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <cstddef>
+
+// 把阈值宏替换为可在运行时修改的变量，以便在同一个程序中比较不同的算法
+static size_t g_karatsuba_threshold = std::numeric_limits<size_t>::max();
+#define OMNIINT_KARATSUBA_THRESHOLD g_karatsuba_threshold
+static size_t g_ntt_threshold = std::numeric_limits<size_t>::max();
+#define OMNIINT_NTT_THRESHOLD g_ntt_threshold
+static size_t g_fft_threshold = std::numeric_limits<size_t>::max();
+#define OMNIINT_FFT_THRESHOLD g_fft_threshold
+static size_t g_ssa_threshold = std::numeric_limits<size_t>::max();
+#define OMNIINT_SSA_THRESHOLD g_ssa_threshold
+static size_t g_hgcd_threshold = std::numeric_limits<size_t>::max();
+#define OMNIINT_HGCD_THRESHOLD g_hgcd_threshold
+
+#include "OmniInt.h"
+#include "OmniIntContinuedFraction.h"
+
+// =========================================================================
+// 计时辅助函数
+// =========================================================================
+
+static std::mt19937_64 g_rng(20250101);
+
+static OmniInt random_operand(size_t digits)
+{
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::string s(digits, '0');
+    s[0] = static_cast<char>('1' + digit(g_rng) % 9);
+    for (size_t i = 1; i < digits; ++i)
+    {
+        s[i] = static_cast<char>('0' + digit(g_rng));
+    }
+    return OmniInt(s);
+}
+
+/**
+ * @brief 测量在给定阈值下 a * b 的单次耗时 (纳秒)
+ *
+ * 每轮重复运算直到耗时超过约 2ms，取 rounds 轮中的最小值以减少噪声。
+ */
+static double time_multiply(const OmniInt &a, const OmniInt &b, size_t threshold,
+                            size_t ntt_threshold = std::numeric_limits<size_t>::max(),
+                            size_t fft_threshold = std::numeric_limits<size_t>::max(),
+                            size_t ssa_threshold = std::numeric_limits<size_t>::max(), int rounds = 5)
+{
+    g_karatsuba_threshold = threshold;
+    g_ntt_threshold = ntt_threshold;
+    g_fft_threshold = fft_threshold;
+    g_ssa_threshold = ssa_threshold;
+    double best = std::numeric_limits<double>::max();
+    for (int round = 0; round < rounds; ++round)
+    {
+        long long reps = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::duration elapsed;
+        do
+        {
+            OmniInt c = a * b;
+            ++reps;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed < std::chrono::milliseconds(2));
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / reps;
+        best = std::min(best, ns);
+    }
+    return best;
+}
+
+/**
+ * @brief 测量在给定的 half-GCD 阈值下展开 p / q 的单次耗时 (纳秒)，计时方式与 time_multiply() 相同
+ */
+static double time_continued_fraction(const OmniInt &p, const OmniInt &q, size_t hgcd_threshold)
+{
+    g_hgcd_threshold = hgcd_threshold;
+    double best = std::numeric_limits<double>::max();
+    for (int round = 0; round < 5; ++round)
+    {
+        long long reps = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::duration elapsed;
+        do
+        {
+            std::vector<OmniInt> quotients = continued_fraction(p, q);
+            ++reps;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed < std::chrono::milliseconds(2));
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / reps;
+        best = std::min(best, ns);
+    }
+    return best;
+}
+
+/**
+ * @brief 在测量的范围内新算法从未更快时的阈值
+ *
+ * 返回 size_t 的最大值，即不启用该算法 (写入头文件时为 SIZE_MAX)；后续的测量也按不启用计时。
+ * 不能返回测量过的最大长度：新算法恰好在那里被测得更慢。
+ */
+static size_t no_crossover(size_t largest)
+{
+    std::cout << "  no crossover found up to " << largest << " digits" << std::endl;
+    return std::numeric_limits<size_t>::max();
+}
+
+static std::string threshold_text(size_t threshold)
+{
+    return threshold == std::numeric_limits<size_t>::max() ? "SIZE_MAX" : std::to_string(threshold);
+}
+
+// =========================================================================
+// 各分界点的测量
+// =========================================================================
+
+/**
+ * @brief 朴素乘法 vs Karatsuba 乘法
+ *
+ * 对每个长度 n，比较纯朴素乘法与"顶层拆分一次、其余使用朴素乘法"的耗时。
+ * 连续两个长度上 Karatsuba 都更快时，取其中较小的长度作为阈值。
+ */
+static size_t tune_karatsuba()
+{
+    std::cout << "\n--- Schoolbook vs Karatsuba multiplication ---\n";
+    std::cout << "  digits  schoolbook(ns)  karatsuba(ns)\n";
+
+    const size_t sizes[] = {8, 12, 16, 24, 32, 40, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512};
+    size_t candidate = 0;
+    for (size_t n : sizes)
+    {
+        OmniInt a = random_operand(n), b = random_operand(n);
+        double basecase = time_multiply(a, b, std::numeric_limits<size_t>::max());
+        double karatsuba = time_multiply(a, b, n);
+        std::cout << "  " << n << "  " << basecase << "  " << karatsuba << std::endl;
+
+        if (karatsuba < basecase)
+        {
+            if (candidate != 0)
+                return candidate;
+            candidate = n;
+        }
+        else
+        {
+            candidate = 0;
+        }
+    }
+    return candidate != 0 ? candidate : no_crossover(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+}
+
+/**
+ * @brief Karatsuba 乘法 vs NTT 乘法
+ *
+ * Karatsuba 使用已经测得的阈值。判定规则与 tune_karatsuba() 相同。
+ */
+static size_t tune_ntt(size_t karatsuba)
+{
+    std::cout << "\n--- Karatsuba vs NTT multiplication ---\n";
+    std::cout << "  digits  karatsuba(ns)  ntt(ns)\n";
+
+    const size_t sizes[] = {64, 96, 128, 160, 192, 256, 320, 384, 512, 768, 1024, 1536, 2048, 3072, 4096};
+    size_t candidate = 0;
+    for (size_t n : sizes)
+    {
+        OmniInt a = random_operand(n), b = random_operand(n);
+        double karatsuba_ns = time_multiply(a, b, karatsuba);
+        double ntt_ns = time_multiply(a, b, karatsuba, n);
+        std::cout << "  " << n << "  " << karatsuba_ns << "  " << ntt_ns << std::endl;
+
+        if (ntt_ns < karatsuba_ns)
+        {
+            if (candidate != 0)
+                return candidate;
+            candidate = n;
+        }
+        else
+        {
+            candidate = 0;
+        }
+    }
+    return candidate != 0 ? candidate : no_crossover(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+}
+
+/**
+ * @brief 已测得阈值下的 Karatsuba / NTT 乘法 vs 浮点 FFT 乘法
+ */
+static size_t tune_fft(size_t karatsuba, size_t ntt)
+{
+    std::cout << "\n--- Karatsuba / NTT vs FFT multiplication ---\n";
+    std::cout << "  digits  karatsuba/ntt(ns)  fft(ns)\n";
+
+    const size_t sizes[] = {32, 48, 64, 96, 128, 160, 192, 256, 320, 384, 512, 768, 1024, 1536, 2048};
+    size_t candidate = 0;
+    for (size_t n : sizes)
+    {
+        OmniInt a = random_operand(n), b = random_operand(n);
+        double before = time_multiply(a, b, karatsuba, ntt);
+        double fft_ns = time_multiply(a, b, karatsuba, ntt, n);
+        std::cout << "  " << n << "  " << before << "  " << fft_ns << std::endl;
+
+        if (fft_ns < before)
+        {
+            if (candidate != 0)
+                return candidate;
+            candidate = n;
+        }
+        else
+        {
+            candidate = 0;
+        }
+    }
+    return candidate != 0 ? candidate : no_crossover(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+}
+
+/**
+ * @brief NTT 乘法 vs Schönhage-Strassen 乘法
+ *
+ * FFT 的误差上界允许时总是优先使用 FFT，OMNIINT_SSA_THRESHOLD 只在 FFT 不可用时
+ * (操作数极长，或关闭了 FFT) 决定使用 NTT 还是 SSA，因此这里关闭 FFT 后比较两者。
+ * SSA 的阈值设为 n，只有最外层使用 SSA，逐点乘法仍按已测得的阈值选择算法。
+ * 每个长度只测一轮；最长的规模单次乘法需要十几秒，整轮测量约需一两分钟。
+ */
+static size_t tune_ssa(size_t karatsuba, size_t ntt)
+{
+    std::cout << "\n--- NTT vs Schonhage-Strassen multiplication (FFT disabled) ---\n";
+    std::cout << "  digits  ntt(ns)  ssa(ns)\n";
+
+    const size_t none = std::numeric_limits<size_t>::max();
+    const size_t sizes[] = {1000000, 2000000, 4000000, 8000000, 16000000, 32000000};
+    size_t candidate = 0;
+    for (size_t n : sizes)
+    {
+        OmniInt a = random_operand(n), b = random_operand(n);
+        double ntt_ns = time_multiply(a, b, karatsuba, ntt, none, none, 1);
+        double ssa_ns = time_multiply(a, b, karatsuba, ntt, none, n, 1);
+        std::cout << "  " << n << "  " << ntt_ns << "  " << ssa_ns << std::endl;
+
+        if (ssa_ns < ntt_ns)
+        {
+            if (candidate != 0)
+                return candidate;
+            candidate = n;
+        }
+        else
+        {
+            candidate = 0;
+        }
+    }
+    return candidate != 0 ? candidate : no_crossover(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+}
+
+/**
+ * @brief 连分数展开：单字 Lehmer 步 vs half-GCD
+ *
+ * 对每个长度 n，比较全程使用 Lehmer 步与"最外层用 half-GCD 把 x 缩短一半、其余使用 Lehmer 步"的耗时，
+ * 其中的乘法使用已测得的阈值。判定规则与 tune_karatsuba() 相同。
+ */
+static size_t tune_hgcd(size_t karatsuba, size_t ntt, size_t fft, size_t ssa)
+{
+    std::cout << "\n--- Lehmer vs half-GCD continued fractions ---\n";
+    std::cout << "  digits  lehmer(ns)  hgcd(ns)\n";
+
+    g_karatsuba_threshold = karatsuba;
+    g_ntt_threshold = ntt;
+    g_fft_threshold = fft;
+    g_ssa_threshold = ssa;
+    const size_t sizes[] = {64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096};
+    size_t candidate = 0;
+    for (size_t n : sizes)
+    {
+        OmniInt p = random_operand(n), q = random_operand(n);
+        double lehmer = time_continued_fraction(p, q, std::numeric_limits<size_t>::max());
+        double hgcd = time_continued_fraction(p, q, n);
+        std::cout << "  " << n << "  " << lehmer << "  " << hgcd << std::endl;
+
+        if (hgcd < lehmer)
+        {
+            if (candidate != 0)
+                return candidate;
+            candidate = n;
+        }
+        else
+        {
+            candidate = 0;
+        }
+    }
+    return candidate != 0 ? candidate : no_crossover(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+}
+
+// =========================================================================
+// 主函数
+// =========================================================================
+
+int main(int argc, char **argv)
+{
+    const std::string output = argc > 1 ? argv[1] : "OmniInt_thresholds.h";
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "     OmniInt Threshold Tuning           " << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    size_t karatsuba = tune_karatsuba();
+    size_t ntt = tune_ntt(karatsuba);
+    size_t fft = tune_fft(karatsuba, ntt);
+    size_t ssa = tune_ssa(karatsuba, ntt);
+    size_t hgcd = tune_hgcd(karatsuba, ntt, fft, ssa);
+    std::cout << "\nOMNIINT_KARATSUBA_THRESHOLD = " << threshold_text(karatsuba) << std::endl;
+    std::cout << "OMNIINT_NTT_THRESHOLD = " << threshold_text(ntt) << std::endl;
+    std::cout << "OMNIINT_FFT_THRESHOLD = " << threshold_text(fft) << std::endl;
+    std::cout << "OMNIINT_SSA_THRESHOLD = " << threshold_text(ssa) << std::endl;
+    std::cout << "OMNIINT_HGCD_THRESHOLD = " << threshold_text(hgcd) << std::endl;
+
+    // 除法只有逐位试商的长除法，gcd() 只有欧几里得算法；half-GCD 只用于连分数展开
+    std::cout << "Division: only long division is implemented, nothing to tune." << std::endl;
+    std::cout << "gcd(): only Euclid's algorithm is implemented; the half-GCD threshold applies to "
+                 "OmniIntContinuedFraction.h." << std::endl;
+
+    std::ofstream out(output.c_str());
+    if (!out)
+    {
+        std::cerr << "Cannot write " << output << std::endl;
+        return 1;
+    }
+    out << "// Generated by tune_omniint.cpp. Do not edit.\n"
+        << "// Consumed by OmniInt.h when OMNIINT_USE_TUNED_THRESHOLDS is defined.\n"
+        << "#ifndef OmniInt_thresholds_H\n"
+        << "#define OmniInt_thresholds_H\n\n"
+        << "#include <cstdint> // SIZE_MAX: no crossover found in the measured range\n\n"
+        << "#ifndef OMNIINT_KARATSUBA_THRESHOLD\n"
+        << "#define OMNIINT_KARATSUBA_THRESHOLD " << threshold_text(karatsuba) << "\n"
+        << "#endif\n\n"
+        << "#ifndef OMNIINT_NTT_THRESHOLD\n"
+        << "#define OMNIINT_NTT_THRESHOLD " << threshold_text(ntt) << "\n"
+        << "#endif\n\n"
+        << "#ifndef OMNIINT_FFT_THRESHOLD\n"
+        << "#define OMNIINT_FFT_THRESHOLD " << threshold_text(fft) << "\n"
+        << "#endif\n\n"
+        << "#ifndef OMNIINT_SSA_THRESHOLD\n"
+        << "#define OMNIINT_SSA_THRESHOLD " << threshold_text(ssa) << "\n"
+        << "#endif\n\n"
+        << "#ifndef OMNIINT_HGCD_THRESHOLD\n"
+        << "#define OMNIINT_HGCD_THRESHOLD " << threshold_text(hgcd) << "\n"
+        << "#endif\n\n"
+        << "#endif // OmniInt_thresholds_H\n";
+
+    std::cout << "Thresholds written to " << output << std::endl;
+    return 0;
+}